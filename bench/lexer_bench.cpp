@@ -0,0 +1,151 @@
+#include "../parser.tab.hpp"
+#include "../compilation_context.hpp"
+#include "../lexer/scan_kernels.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+
+using std::string;
+using std::vector;
+
+struct bench_result
+{
+    double seconds;
+    size_t tokens;
+    size_t checksum;
+};
+
+static string generate_corpus(size_t target_size)
+{
+    std::stringstream corpus;
+
+    for (size_t i = 0; static_cast<size_t>(corpus.tellp()) < target_size; i++)
+    {
+        corpus << "// generated function " << i << "\n";
+        corpus << "int function" << i << "(int value, byte small, bool flag)\n{\n";
+        corpus << "    int counter" << i << " = " << i << ";\n";
+        corpus << "    while (counter" << i << " < 1000 and not flag)\n    {\n";
+        corpus << "        if (counter" << i << " / 7 * 7 == counter" << i << ") { print(\"multiple of \\\"seven\\\"\"); continue; }\n";
+        corpus << "        counter" << i << " = counter" << i << " + value * 2 - (int)small;\n";
+        corpus << "        if (counter" << i << " >= 500) break;\n    }\n";
+        corpus << "    return counter" << i << " if (flag or value != 0) else 255;\n}\n\n";
+    }
+
+    return corpus.str();
+}
+
+static void mix(size_t& checksum, int kind, int line)
+{
+    checksum = checksum * 1000003 ^ (static_cast<size_t>(kind) << 32 | static_cast<size_t>(line));
+}
+
+static bench_result run_tokens(compilation_context& context)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    syntax_token* token = nullptr;
+
+    bench_result result = { 0, 0, 0 };
+
+    for (int kind = context.next_token(token); kind != END; kind = context.next_token(token))
+    {
+        mix(result.checksum, kind, context.line());
+        result.tokens++;
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return result;
+}
+
+static bench_result run_flex(const string& corpus)
+{
+    vector<char> buffer(corpus.begin(), corpus.end());
+    buffer.resize(buffer.size() + 2, '\0');
+
+    compilation_context context;
+    context.scan_mapped_input(buffer.data(), buffer.size());
+
+    return run_tokens(context);
+}
+
+static bench_result run_fast(const string& corpus, const scan_kernels& kernels)
+{
+    compilation_context context;
+    context.scan_with_fast_lexer(corpus, kernels);
+
+    return run_tokens(context);
+}
+
+static bench_result best_of(int runs, const std::function<bench_result()>& run)
+{
+    bench_result best = run();
+
+    for (int i = 1; i < runs; i++)
+    {
+        bench_result current = run();
+
+        if (current.seconds < best.seconds)
+        {
+            best = current;
+        }
+    }
+
+    return best;
+}
+
+static void report(const string& name, const bench_result& result, const bench_result& reference, size_t bytes)
+{
+    double megabytes = static_cast<double>(bytes) / (1024 * 1024);
+
+    std::cout << name << ": " << result.seconds * 1000 << " ms, " << megabytes / result.seconds << " MB/s, " << result.tokens << " tokens";
+    std::cout << (result.checksum == reference.checksum && result.tokens == reference.tokens ? "" : " (token stream differs from flex)") << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    string corpus;
+
+    if (argc > 1)
+    {
+        std::ifstream file(argv[1], std::ios::binary);
+
+        if (file.fail())
+        {
+            std::cerr << "cannot open " << argv[1] << std::endl;
+            return 1;
+        }
+
+        corpus.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    else
+    {
+        corpus = generate_corpus(64 * 1024 * 1024);
+    }
+
+    const int runs = 5;
+
+    bench_result flex = best_of(runs, [&]() { return run_flex(corpus); });
+
+    report("flex", flex, flex, corpus.size());
+
+    vector<const scan_kernels*> kernels = { &scan_kernels::scalar(), &scan_kernels::sse2() };
+
+    if (scan_kernels::avx2_supported())
+    {
+        kernels.push_back(&scan_kernels::avx2());
+    }
+
+    for (const scan_kernels* kernel : kernels)
+    {
+        bench_result fast = best_of(runs, [&]() { return run_fast(corpus, *kernel); });
+
+        report(string("fast_lexer/") + kernel->name, fast, flex, corpus.size());
+    }
+
+    return 0;
+}
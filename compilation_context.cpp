@@ -0,0 +1,153 @@
+#include "compilation_context.hpp"
+#include "lexer/fast_lexer.hpp"
+#include "syntax/generic_syntax.hpp"
+#include "emit/ir_printer.hpp"
+#include "emit/bitcode_writer.hpp"
+#include "parser.tab.hpp"
+#include <stdexcept>
+#include <utility>
+
+extern void* create_scanner();
+extern void destroy_scanner(void* scanner);
+extern void scan_mapped_input(void* scanner, char* data, std::size_t size);
+extern int scanner_line(void* scanner);
+extern int flex_lex(YYSTYPE* value, void* scanner);
+
+thread_local compilation_context* compilation_context::_current = nullptr;
+
+compilation_context::compilation_context():
+    _previous(std::exchange(_current, this)), _global_count(0), _scanner(create_scanner()), _lexer(),
+    _streaming(false), _bitcode(false), _compact(false), _memory_locals(false), _function_arena(), _function_ir(), _function_symbols(0), identifier_arena(), syntax_arena(), ir_arena(), identifiers(identifier_arena), symbols(),
+    module(), builder(*this, ir_arena, module), code()
+{
+}
+
+compilation_context::~compilation_context()
+{
+    destroy_scanner(_scanner);
+
+    _current = _previous;
+}
+
+compilation_context& compilation_context::current()
+{
+    if (_current == nullptr)
+    {
+        throw std::logic_error("no compilation_context on this thread");
+    }
+
+    return *_current;
+}
+
+unsigned long long compilation_context::next_global()
+{
+    return _global_count++;
+}
+
+void compilation_context::scan_mapped_input(char* data, std::size_t size)
+{
+    ::scan_mapped_input(_scanner, data, size);
+}
+
+void compilation_context::scan_with_fast_lexer(std::string_view source, const scan_kernels& kernels)
+{
+    _lexer = std::make_unique<fast_lexer>(source, kernels);
+}
+
+int compilation_context::next_token(syntax_token*& token)
+{
+    if (_lexer != nullptr)
+    {
+        return _lexer->next(token);
+    }
+
+    YYSTYPE value;
+    value.token = nullptr;
+
+    int kind = flex_lex(&value, _scanner);
+
+    token = value.token;
+
+    return kind;
+}
+
+void compilation_context::enable_streaming()
+{
+    _streaming = true;
+}
+
+bool compilation_context::streaming() const
+{
+    return _streaming;
+}
+
+void compilation_context::enable_bitcode()
+{
+    _bitcode = true;
+}
+
+bool compilation_context::bitcode() const
+{
+    return _bitcode;
+}
+
+void compilation_context::enable_compact()
+{
+    _compact = true;
+}
+
+bool compilation_context::compact() const
+{
+    return _compact;
+}
+
+void compilation_context::enable_memory_locals()
+{
+    _memory_locals = true;
+}
+
+bool compilation_context::memory_locals() const
+{
+    return _memory_locals;
+}
+
+// called when no token of the next function has been read yet
+void compilation_context::begin_function()
+{
+    _function_arena = syntax_arena.mark();
+    _function_ir = ir_arena.mark();
+    _function_symbols = symbols.mark();
+}
+
+// emits and writes out a finished function, then releases its syntax tree, tokens, locals and ir
+void compilation_context::stream_function(function_declaration_syntax* function)
+{
+    function->emit();
+
+    ir_printer(code, _compact).print(module);
+    code.flush();
+
+    module.clear_bodies();
+    ir_arena.rewind(_function_ir);
+    syntax_arena.rewind(_function_arena);
+    symbols.rewind(_function_symbols);
+}
+
+void compilation_context::write_module()
+{
+    builder.define_builtin_functions();
+
+    if (_bitcode)
+    {
+        bitcode_writer(code).write(module);
+    }
+    else
+    {
+        ir_printer(code, _compact).print(module);
+    }
+}
+
+int compilation_context::line() const
+{
+    return _lexer != nullptr ? _lexer->line() : scanner_line(_scanner);
+}
@@ -0,0 +1,87 @@
+#ifndef _COMPILATION_CONTEXT_HPP_
+#define _COMPILATION_CONTEXT_HPP_
+
+#include "memory/arena.hpp"
+#include "symbol/identifier_table.hpp"
+#include "symbol/symbol_table.hpp"
+#include "emit/code_buffer.hpp"
+#include "emit/ir.hpp"
+#include "emit/ir_builder.hpp"
+#include "lexer/scan_kernels.hpp"
+#include <memory>
+#include <string_view>
+
+class fast_lexer;
+class syntax_token;
+class function_declaration_syntax;
+
+// owns all state of a single compilation, the context constructed last on a thread is the one instance() accessors resolve to
+class compilation_context
+{
+    private:
+
+    static thread_local compilation_context* _current;
+
+    compilation_context* const _previous;
+
+    unsigned long long _global_count;
+
+    void* const _scanner;
+    std::unique_ptr<fast_lexer> _lexer;
+
+    bool _streaming;
+    bool _bitcode;
+    bool _compact;
+    bool _memory_locals;
+    arena::marker _function_arena;
+    arena::marker _function_ir;
+    std::size_t _function_symbols;
+
+    public:
+
+    arena identifier_arena;
+    arena syntax_arena;
+    arena ir_arena;
+    identifier_table identifiers;
+    symbol_table symbols;
+    ir_module module;
+    ir_builder builder;
+    code_buffer code;
+
+    compilation_context();
+
+    compilation_context(const compilation_context& other) = delete;
+    compilation_context& operator=(const compilation_context& other) = delete;
+
+    ~compilation_context();
+
+    static compilation_context& current();
+
+    unsigned long long next_global();
+
+    void scan_mapped_input(char* data, std::size_t size);
+    void scan_with_fast_lexer(std::string_view source, const scan_kernels& kernels = scan_kernels::best());
+
+    int next_token(syntax_token*& token);
+
+    void enable_streaming();
+    bool streaming() const;
+
+    void enable_bitcode();
+    bool bitcode() const;
+
+    void enable_compact();
+    bool compact() const;
+
+    // keeps locals in stack slots instead of building SSA values
+    void enable_memory_locals();
+    bool memory_locals() const;
+
+    void begin_function();
+    void stream_function(function_declaration_syntax* function);
+    void write_module();
+
+    int line() const;
+};
+
+#endif
@@ -0,0 +1,582 @@
+#include "bitcode_writer.hpp"
+#include <stdexcept>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+// block, record and operand codes from LLVM's LLVMBitCodes.h
+namespace
+{
+    enum block_id : unsigned
+    {
+        ModuleBlock = 8, ConstantsBlock = 11, FunctionBlock = 12, ValueSymbolTableBlock = 14, TypeBlock = 17
+    };
+
+    enum module_code : unsigned { ModuleVersion = 1, ModuleGlobalVariable = 7, ModuleFunction = 8 };
+
+    enum type_code : unsigned
+    {
+        TypeEntryCount = 1, TypeVoid = 2, TypeLabel = 5, TypeInteger = 7, TypePointer = 8, TypeArray = 11, TypeFunction = 21
+    };
+
+    enum constant_code : unsigned { ConstantSetType = 1, ConstantUndefined = 3, ConstantInteger = 4, ConstantString = 8 };
+
+    enum symbol_code : unsigned { SymbolEntry = 1 };
+
+    enum instruction_code : unsigned
+    {
+        DeclareBlocks = 1, InstructionBinary = 2, InstructionCast = 3, InstructionRet = 10, InstructionBr = 11, InstructionUnreachable = 15, InstructionPhi = 16,
+        InstructionAlloca = 19, InstructionLoad = 20, InstructionCompare = 28, InstructionSelect = 29,
+        InstructionCall = 34, InstructionElementPointer = 43, InstructionStore = 44
+    };
+
+    constexpr uint64_t alloca_explicit_type = 1 << 6;
+    constexpr uint64_t call_explicit_type = 1 << 15;
+
+    uint64_t signed_operand(int64_t value)
+    {
+        return value >= 0 ? uint64_t(value) << 1 : (uint64_t(-value) << 1) | 1;
+    }
+
+    uint64_t binary_code(ir_opcode opcode)
+    {
+        switch (opcode)
+        {
+            case ir_opcode::Add: return 0;
+            case ir_opcode::Sub: return 1;
+            case ir_opcode::Mul: return 2;
+            case ir_opcode::UDiv: return 3;
+            case ir_opcode::SDiv: return 4;
+            case ir_opcode::And: return 10;
+
+            default: throw std::runtime_error("not a binary opcode");
+        }
+    }
+
+    uint64_t cast_code(ir_opcode opcode)
+    {
+        switch (opcode)
+        {
+            case ir_opcode::Trunc: return 0;
+            case ir_opcode::ZExt: return 1;
+
+            default: throw std::runtime_error("not a cast opcode");
+        }
+    }
+
+    uint64_t predicate_code(ir_predicate predicate)
+    {
+        switch (predicate)
+        {
+            case ir_predicate::Eq: return 32;
+            case ir_predicate::Ne: return 33;
+            case ir_predicate::Ugt: return 34;
+            case ir_predicate::Uge: return 35;
+            case ir_predicate::Ult: return 36;
+            case ir_predicate::Ule: return 37;
+            case ir_predicate::Sgt: return 38;
+            case ir_predicate::Sge: return 39;
+            case ir_predicate::Slt: return 40;
+            case ir_predicate::Sle: return 41;
+
+            default: throw std::runtime_error("no predicate");
+        }
+    }
+
+    void push_name(vector<uint64_t>& record, string_view name)
+    {
+        for (char c : name)
+        {
+            record.push_back(static_cast<unsigned char>(c));
+        }
+    }
+}
+
+bitcode_writer::bitcode_writer(code_buffer& code):
+    _code(code), _stream(), _functions(), _type_ids(), _types(), _scalar_types(), _function_types(), _global_ids(), _value_ids(), _function_ids(), _constant_ids(), _undefined_ids(), _contents(), _record(), _module_values(0)
+{
+}
+
+uint32_t bitcode_writer::intern_type(const vector<uint64_t>& record)
+{
+    auto found = _type_ids.find(record);
+
+    if (found != _type_ids.end())
+    {
+        return found->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(_types.size());
+
+    _types.push_back(record);
+    _type_ids.emplace(record, id);
+
+    return id;
+}
+
+uint32_t bitcode_writer::type_id(ir_type type) const
+{
+    if (type == ir_type::Pointer)
+    {
+        throw std::runtime_error("type has no bitcode id");
+    }
+
+    return _scalar_types[static_cast<size_t>(type)];
+}
+
+uint32_t bitcode_writer::array_type(size_t size)
+{
+    return intern_type({ TypeArray, size, type_id(ir_type::I8) });
+}
+
+uint32_t bitcode_writer::function_type(const ir_function* function)
+{
+    return _function_types.at(function);
+}
+
+// every type a record can name is interned up front, the table has to precede its users
+void bitcode_writer::write_types(const ir_module& module)
+{
+    _scalar_types[static_cast<size_t>(ir_type::Void)] = intern_type({ TypeVoid });
+    _scalar_types[static_cast<size_t>(ir_type::Label)] = intern_type({ TypeLabel });
+    _scalar_types[static_cast<size_t>(ir_type::I1)] = intern_type({ TypeInteger, 1 });
+    _scalar_types[static_cast<size_t>(ir_type::I8)] = intern_type({ TypeInteger, 8 });
+    _scalar_types[static_cast<size_t>(ir_type::I32)] = intern_type({ TypeInteger, 32 });
+    _scalar_types[static_cast<size_t>(ir_type::I8Ptr)] = intern_type({ TypePointer, type_id(ir_type::I8), 0 });
+
+    for (const ir_global* global : module.globals())
+    {
+        _contents.push_back(global->bytes());
+        array_type(_contents.back().size() + 1);
+    }
+
+    for (const ir_function* function : _functions)
+    {
+        vector<uint64_t> record = { TypeFunction, function->variadic, type_id(function->return_type) };
+
+        for (ir_type type : function->parameter_types)
+        {
+            record.push_back(type_id(type));
+        }
+
+        _function_types[function] = intern_type(record);
+    }
+
+    _stream.enter_block(TypeBlock, 4);
+    _stream.record(TypeEntryCount, { _types.size() });
+
+    for (const vector<uint64_t>& type : _types)
+    {
+        _stream.record(static_cast<unsigned>(type[0]), vector<uint64_t>(type.begin() + 1, type.end()));
+    }
+
+    _stream.exit_block();
+}
+
+// module level value ids run through the globals, then the functions, then the global initializers
+void bitcode_writer::write_globals(const ir_module& module)
+{
+    const vector<ir_global*>& globals = module.globals();
+
+    uint32_t first_initializer = static_cast<uint32_t>(globals.size() + _functions.size());
+
+    for (size_t i = 0; i < globals.size(); i++)
+    {
+        _global_ids[globals[i]] = static_cast<uint32_t>(i);
+
+        // explicit value type and constant, initializer id is biased by one, external linkage
+        _stream.record(ModuleGlobalVariable, { array_type(_contents[i].size() + 1), 3, first_initializer + i + 1, 0, 0, 0 });
+    }
+
+    for (size_t i = 0; i < _functions.size(); i++)
+    {
+        const ir_function* function = _functions[i];
+
+        _function_ids[function] = static_cast<uint32_t>(globals.size() + i);
+
+        // C calling convention, external linkage, no attributes, alignment, section, visibility or gc
+        _stream.record(ModuleFunction, { function_type(function), 0, function->defined() ? 0u : 1u, 0, 0, 0, 0, 0, 0, 0 });
+    }
+
+    _module_values = first_initializer + static_cast<uint32_t>(globals.size());
+
+    if (globals.empty())
+    {
+        return;
+    }
+
+    _stream.enter_block(ConstantsBlock, 4);
+
+    for (const string& content : _contents)
+    {
+        vector<uint64_t> record;
+
+        push_name(record, content);
+        record.push_back(0);
+
+        _stream.record(ConstantSetType, { array_type(content.size() + 1) });
+        _stream.record(ConstantString, record);
+    }
+
+    _stream.exit_block();
+}
+
+uint32_t bitcode_writer::value_id(const ir_value* value) const
+{
+    switch (value->value_kind)
+    {
+        case ir_value_kind::Constant: return _constant_ids.at({ value->type, static_cast<const ir_constant*>(value)->value });
+        case ir_value_kind::Undefined: return _undefined_ids.at(value->type);
+        case ir_value_kind::Global: return _global_ids.at(value);
+
+        default: return _value_ids.at(value);
+    }
+}
+
+// operands are relative to the id of the instruction being written
+void bitcode_writer::push_value(vector<uint64_t>& record, const ir_value* value, uint32_t id) const
+{
+    record.push_back(static_cast<uint32_t>(id - value_id(value)));
+}
+
+// a forward reference also carries its type, the reader has not seen the value yet
+void bitcode_writer::push_typed(vector<uint64_t>& record, const ir_value* value, uint32_t id) const
+{
+    push_value(record, value, id);
+
+    if (value_id(value) >= id)
+    {
+        record.push_back(type_id(value->type));
+    }
+}
+
+void bitcode_writer::write_constants(uint32_t first_id)
+{
+    uint32_t id = first_id;
+    bool first = true;
+    ir_type current = ir_type::Void;
+
+    _stream.enter_block(ConstantsBlock, 4);
+
+    for (auto& entry : _constant_ids)
+    {
+        if (first || entry.first.first != current)
+        {
+            current = entry.first.first;
+            first = false;
+
+            _stream.record(ConstantSetType, { type_id(current) });
+        }
+
+        // byte constants are kept zero extended, the bitcode holds them sign extended like llvm does
+        int64_t value = current == ir_type::I8 ? static_cast<int8_t>(entry.first.second) : entry.first.second;
+
+        _stream.record(ConstantInteger, { signed_operand(value) });
+
+        entry.second = id++;
+    }
+
+    for (auto& entry : _undefined_ids)
+    {
+        _stream.record(ConstantSetType, { type_id(entry.first) });
+        _stream.record(ConstantUndefined, {});
+
+        entry.second = id++;
+    }
+
+    _stream.exit_block();
+}
+
+void bitcode_writer::write_function(const ir_function* function)
+{
+    uint32_t next_id = _module_values;
+    uint32_t block_count = 0;
+
+    _value_ids.clear();
+    _constant_ids.clear();
+    _undefined_ids.clear();
+
+    for (size_t i = 0; i < function->parameter_types.size(); i++)
+    {
+        _value_ids[function->arguments[i]] = next_id++;
+    }
+
+    for (const ir_basic_block* block = function->first_block; block != nullptr; block = block->next)
+    {
+        _value_ids[block] = block_count++;
+
+        for (const ir_instruction* instruction = block->first; instruction != nullptr; instruction = instruction->next)
+        {
+            for (uint32_t i = 0; i < instruction->operand_count; i++)
+            {
+                const ir_value* operand = instruction->operand(i);
+
+                if (operand->value_kind == ir_value_kind::Constant)
+                {
+                    _constant_ids.emplace(std::make_pair(operand->type, static_cast<const ir_constant*>(operand)->value), 0);
+                }
+                else if (operand->value_kind == ir_value_kind::Undefined)
+                {
+                    _undefined_ids.emplace(operand->type, 0);
+                }
+            }
+
+            if (instruction->opcode == ir_opcode::Alloca)
+            {
+                _constant_ids.emplace(std::make_pair(ir_type::I32, 1LL), 0);
+            }
+            else if (instruction->opcode == ir_opcode::ElementPointer)
+            {
+                _constant_ids.emplace(std::make_pair(ir_type::I32, 0LL), 0);
+            }
+        }
+    }
+
+    _stream.enter_block(FunctionBlock, 4);
+    _stream.record(DeclareBlocks, { block_count });
+
+    if (_constant_ids.empty() == false || _undefined_ids.empty() == false)
+    {
+        write_constants(next_id);
+        next_id += static_cast<uint32_t>(_constant_ids.size() + _undefined_ids.size());
+    }
+
+    // instruction ids are known before writing, phis may refer to values defined further down
+    uint32_t first_instruction = next_id;
+
+    for (const ir_basic_block* block = function->first_block; block != nullptr; block = block->next)
+    {
+        for (const ir_instruction* instruction = block->first; instruction != nullptr; instruction = instruction->next)
+        {
+            if (instruction->type != ir_type::Void)
+            {
+                _value_ids[instruction] = next_id++;
+            }
+        }
+    }
+
+    next_id = first_instruction;
+
+    for (const ir_basic_block* block = function->first_block; block != nullptr; block = block->next)
+    {
+        for (const ir_instruction* instruction = block->first; instruction != nullptr; instruction = instruction->next)
+        {
+            _record.clear();
+            write_instruction(instruction, next_id, _record);
+
+            if (instruction->type != ir_type::Void)
+            {
+                next_id++;
+            }
+        }
+    }
+
+    _stream.exit_block();
+}
+
+void bitcode_writer::write_instruction(const ir_instruction* instruction, uint32_t id, vector<uint64_t>& record)
+{
+    switch (instruction->opcode)
+    {
+        case ir_opcode::Add:
+        case ir_opcode::Sub:
+        case ir_opcode::Mul:
+        case ir_opcode::SDiv:
+        case ir_opcode::UDiv:
+        case ir_opcode::And:
+            push_typed(record, instruction->operand(0), id);
+            push_value(record, instruction->operand(1), id);
+            record.push_back(binary_code(instruction->opcode));
+            _stream.record(InstructionBinary, record);
+            break;
+
+        case ir_opcode::ZExt:
+        case ir_opcode::Trunc:
+            push_typed(record, instruction->operand(0), id);
+            record.push_back(type_id(instruction->type));
+            record.push_back(cast_code(instruction->opcode));
+            _stream.record(InstructionCast, record);
+            break;
+
+        case ir_opcode::ICmp:
+            push_typed(record, instruction->operand(0), id);
+            push_value(record, instruction->operand(1), id);
+            record.push_back(predicate_code(instruction->predicate));
+            _stream.record(InstructionCompare, record);
+            break;
+
+        case ir_opcode::Select:
+            push_typed(record, instruction->operand(1), id);
+            push_value(record, instruction->operand(2), id);
+            push_typed(record, instruction->operand(0), id);
+            _stream.record(InstructionSelect, record);
+            break;
+
+        case ir_opcode::Phi:
+            record.push_back(type_id(instruction->type));
+
+            for (uint32_t i = 0; i < instruction->operand_count; i += 2)
+            {
+                record.push_back(signed_operand(int64_t(id) - int64_t(value_id(instruction->operand(i)))));
+                record.push_back(value_id(instruction->operand(i + 1)));
+            }
+
+            _stream.record(InstructionPhi, record);
+            break;
+
+        // the size operand is an absolute id, no alignment lets the reader use the preferred one
+        case ir_opcode::Alloca:
+            record.insert(record.end(), { type_id(instruction->allocated_type), type_id(ir_type::I32), _constant_ids.at({ ir_type::I32, 1 }), alloca_explicit_type });
+            _stream.record(InstructionAlloca, record);
+            break;
+
+        case ir_opcode::Load:
+            push_typed(record, instruction->operand(0), id);
+            record.insert(record.end(), { type_id(instruction->type), 0, 0 });
+            _stream.record(InstructionLoad, record);
+            break;
+
+        case ir_opcode::Store:
+            push_typed(record, instruction->operand(1), id);
+            push_typed(record, instruction->operand(0), id);
+            record.insert(record.end(), { 0, 0 });
+            _stream.record(InstructionStore, record);
+            break;
+
+        case ir_opcode::ElementPointer:
+        {
+            uint64_t zero = static_cast<uint32_t>(id - _constant_ids.at({ ir_type::I32, 0 }));
+            size_t size = _contents[value_id(instruction->operand(0))].size() + 1;
+
+            record.insert(record.end(), { 0, array_type(size) });
+            push_value(record, instruction->operand(0), id);
+            record.insert(record.end(), { zero, zero });
+            _stream.record(InstructionElementPointer, record);
+            break;
+        }
+
+        // fixed arguments take their type from the signature, the ones matched by ... are typed
+        case ir_opcode::Call:
+        {
+            const ir_function* callee = instruction->callee;
+
+            record.insert(record.end(), { 0, call_explicit_type, function_type(callee), id - _function_ids.at(callee) });
+
+            for (uint32_t i = 0; i < instruction->operand_count; i++)
+            {
+                if (i < callee->parameter_types.size())
+                {
+                    push_value(record, instruction->operand(i), id);
+                }
+                else
+                {
+                    push_typed(record, instruction->operand(i), id);
+                }
+            }
+
+            _stream.record(InstructionCall, record);
+            break;
+        }
+
+        case ir_opcode::Br:
+            record.push_back(value_id(instruction->operand(0)));
+            _stream.record(InstructionBr, record);
+            break;
+
+        case ir_opcode::CondBr:
+            record.push_back(value_id(instruction->operand(1)));
+            record.push_back(value_id(instruction->operand(2)));
+            push_value(record, instruction->operand(0), id);
+            _stream.record(InstructionBr, record);
+            break;
+
+        case ir_opcode::Ret:
+            if (instruction->operand_count > 0)
+            {
+                push_typed(record, instruction->operand(0), id);
+            }
+
+            _stream.record(InstructionRet, record);
+            break;
+
+        case ir_opcode::Unreachable:
+            _stream.record(InstructionUnreachable, record);
+            break;
+    }
+}
+
+void bitcode_writer::write_symbols(const ir_module& module)
+{
+    _stream.enter_block(ValueSymbolTableBlock, 4);
+
+    for (const ir_global* global : module.globals())
+    {
+        vector<uint64_t> record = { _global_ids.at(global) };
+
+        if (global->name.empty())
+        {
+            push_name(record, ".global_var_" + std::to_string(global->number));
+        }
+        else
+        {
+            push_name(record, global->name);
+        }
+
+        _stream.record(SymbolEntry, record);
+    }
+
+    for (const ir_function* function : _functions)
+    {
+        vector<uint64_t> record = { _function_ids.at(function) };
+
+        push_name(record, function->name);
+
+        _stream.record(SymbolEntry, record);
+    }
+
+    _stream.exit_block();
+}
+
+void bitcode_writer::write(const ir_module& module)
+{
+    for (char magic : { 'B', 'C' })
+    {
+        _stream.emit(static_cast<unsigned char>(magic), 8);
+    }
+
+    for (unsigned nibble : { 0x0, 0xC, 0xE, 0xD })
+    {
+        _stream.emit(nibble, 4);
+    }
+
+    // signatures nothing calls or defines, like unused builtins, are left out
+    for (const auto& function : module.functions())
+    {
+        if (function->defined() || function->referenced)
+        {
+            _functions.push_back(function.get());
+        }
+    }
+
+    _stream.enter_block(ModuleBlock);
+    _stream.record(ModuleVersion, { 1 });
+
+    write_types(module);
+    write_globals(module);
+
+    // bodies follow the function records in the same order, the symbol table may come last
+    for (const ir_function* function : _functions)
+    {
+        if (function->defined())
+        {
+            write_function(function);
+        }
+    }
+
+    write_symbols(module);
+
+    _stream.exit_block();
+
+    _code.write(_stream.bytes());
+}
@@ -0,0 +1,65 @@
+#ifndef _BITCODE_WRITER_HPP_
+#define _BITCODE_WRITER_HPP_
+
+#include "ir.hpp"
+#include "code_buffer.hpp"
+#include "bitstream.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// serializes the module as LLVM bitcode into the code buffer, without going through libLLVM.
+// the module is written in the version 1 layout: relative operand ids and names in a value symbol table
+class bitcode_writer
+{
+    private:
+
+    code_buffer& _code;
+    bitstream _stream;
+    std::vector<const ir_function*> _functions;
+
+    std::map<std::vector<uint64_t>, uint32_t> _type_ids;
+    std::vector<std::vector<uint64_t>> _types;
+    uint32_t _scalar_types[static_cast<std::size_t>(ir_type::Label) + 1];
+    std::unordered_map<const ir_function*, uint32_t> _function_types;
+
+    std::unordered_map<const ir_value*, uint32_t> _global_ids;
+    std::unordered_map<const ir_value*, uint32_t> _value_ids;
+    std::unordered_map<const ir_function*, uint32_t> _function_ids;
+    std::map<std::pair<ir_type, long long>, uint32_t> _constant_ids;
+    std::map<ir_type, uint32_t> _undefined_ids;
+    std::vector<std::string> _contents;
+    std::vector<uint64_t> _record;
+    uint32_t _module_values;
+
+    uint32_t intern_type(const std::vector<uint64_t>& record);
+    uint32_t type_id(ir_type type) const;
+    uint32_t array_type(std::size_t size);
+    uint32_t function_type(const ir_function* function);
+
+    void write_types(const ir_module& module);
+    void write_globals(const ir_module& module);
+    void write_function(const ir_function* function);
+    void write_constants(uint32_t first_id);
+    void write_instruction(const ir_instruction* instruction, uint32_t id, std::vector<uint64_t>& record);
+    void write_symbols(const ir_module& module);
+
+    uint32_t value_id(const ir_value* value) const;
+    void push_value(std::vector<uint64_t>& record, const ir_value* value, uint32_t id) const;
+    void push_typed(std::vector<uint64_t>& record, const ir_value* value, uint32_t id) const;
+
+    public:
+
+    explicit bitcode_writer(code_buffer& code);
+
+    bitcode_writer(const bitcode_writer& other) = delete;
+    bitcode_writer& operator=(const bitcode_writer& other) = delete;
+
+    void write(const ir_module& module);
+};
+
+#endif
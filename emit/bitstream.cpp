@@ -0,0 +1,114 @@
+#include "bitstream.hpp"
+#include <stdexcept>
+
+using std::string;
+using std::vector;
+
+namespace
+{
+    // fixed abbreviation ids every block understands
+    constexpr unsigned end_block = 0;
+    constexpr unsigned enter_subblock = 1;
+    constexpr unsigned unabbreviated_record = 3;
+}
+
+bitstream::bitstream(): _words(), _bytes(), _blocks(), _current(0), _bits(0), _abbreviation_width(2)
+{
+}
+
+void bitstream::emit(uint64_t value, unsigned width)
+{
+    _current |= value << _bits;
+    _bits += width;
+
+    if (_bits >= 32)
+    {
+        _words.push_back(static_cast<uint32_t>(_current));
+
+        _current >>= 32;
+        _bits -= 32;
+    }
+}
+
+void bitstream::emit_vbr(uint64_t value, unsigned width)
+{
+    uint64_t continuation = uint64_t(1) << (width - 1);
+
+    while (value >= continuation)
+    {
+        emit((value & (continuation - 1)) | continuation, width);
+        value >>= width - 1;
+    }
+
+    emit(value, width);
+}
+
+void bitstream::align()
+{
+    if (_bits > 0)
+    {
+        emit(0, 32 - _bits);
+    }
+}
+
+// the block length word is reserved here and filled in by exit_block
+void bitstream::enter_block(unsigned id, unsigned abbreviation_width)
+{
+    emit(enter_subblock, _abbreviation_width);
+    emit_vbr(id, 8);
+    emit_vbr(abbreviation_width, 4);
+    align();
+
+    _blocks.push_back({ _abbreviation_width, _words.size() });
+    _words.push_back(0);
+
+    _abbreviation_width = abbreviation_width;
+}
+
+void bitstream::exit_block()
+{
+    emit(end_block, _abbreviation_width);
+    align();
+
+    open_block block = _blocks.back();
+
+    _blocks.pop_back();
+
+    _words[block.length_word] = static_cast<uint32_t>(_words.size() - block.length_word - 1);
+    _abbreviation_width = block.abbreviation_width;
+}
+
+void bitstream::record(unsigned code, const vector<uint64_t>& operands)
+{
+    emit(unabbreviated_record, _abbreviation_width);
+    emit_vbr(code, 6);
+    emit_vbr(operands.size(), 6);
+
+    for (uint64_t operand : operands)
+    {
+        emit_vbr(operand, 6);
+    }
+}
+
+const string& bitstream::bytes()
+{
+    if (_blocks.empty() == false)
+    {
+        throw std::runtime_error("bitstream has an open block");
+    }
+
+    align();
+
+    _bytes.clear();
+    _bytes.reserve(_words.size() * 4);
+
+    for (uint32_t word : _words)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            _bytes.push_back(static_cast<char>((word >> shift) & 0xff));
+        }
+    }
+
+    return _bytes;
+}
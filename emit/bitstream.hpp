@@ -0,0 +1,48 @@
+#ifndef _BITSTREAM_HPP_
+#define _BITSTREAM_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// LLVM bitstream container: fields are packed from the low bit up into little endian 32-bit words,
+// records are written unabbreviated so no abbreviation definitions or BLOCKINFO are needed
+class bitstream
+{
+    private:
+
+    struct open_block
+    {
+        unsigned abbreviation_width;
+        std::size_t length_word;
+    };
+
+    std::vector<uint32_t> _words;
+    std::string _bytes;
+    std::vector<open_block> _blocks;
+    uint64_t _current;
+    unsigned _bits;
+    unsigned _abbreviation_width;
+
+    void align();
+
+    public:
+
+    bitstream();
+
+    bitstream(const bitstream& other) = delete;
+    bitstream& operator=(const bitstream& other) = delete;
+
+    void emit(uint64_t value, unsigned width);
+    void emit_vbr(uint64_t value, unsigned width);
+
+    void enter_block(unsigned id, unsigned abbreviation_width = 3);
+    void exit_block();
+
+    void record(unsigned code, const std::vector<uint64_t>& operands);
+
+    // little endian bytes of the finished stream, every block must be closed
+    const std::string& bytes();
+};
+
+#endif
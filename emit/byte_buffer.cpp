@@ -0,0 +1,73 @@
+#include "byte_buffer.hpp"
+#include <cstring>
+#include <algorithm>
+#include <utility>
+
+using std::size_t;
+using std::string_view;
+
+byte_buffer::byte_buffer(): _chunks(), _size(0)
+{
+}
+
+byte_buffer::byte_buffer(byte_buffer&& other) noexcept: _chunks(std::move(other._chunks)), _size(std::exchange(other._size, 0))
+{
+    other._chunks.clear();
+}
+
+size_t byte_buffer::size() const
+{
+    return _size;
+}
+
+void byte_buffer::append(string_view text)
+{
+    const char* data = text.data();
+    size_t remaining = text.size();
+
+    while (remaining > 0)
+    {
+        size_t used = _size % chunk_size;
+
+        if (used == 0 && _size / chunk_size == _chunks.size())
+        {
+            _chunks.emplace_back(new char[chunk_size]);
+        }
+
+        size_t count = std::min(remaining, chunk_size - used);
+
+        std::memcpy(_chunks.back().get() + used, data, count);
+
+        data += count;
+        remaining -= count;
+        _size += count;
+    }
+}
+
+char& byte_buffer::operator[](size_t offset)
+{
+    return _chunks[offset / chunk_size][offset % chunk_size];
+}
+
+char byte_buffer::operator[](size_t offset) const
+{
+    return _chunks[offset / chunk_size][offset % chunk_size];
+}
+
+std::vector<string_view> byte_buffer::pieces() const
+{
+    std::vector<string_view> pieces;
+
+    for (size_t begin = 0; begin < _size; begin += chunk_size)
+    {
+        pieces.emplace_back(_chunks[begin / chunk_size].get(), std::min(_size - begin, chunk_size));
+    }
+
+    return pieces;
+}
+
+void byte_buffer::clear()
+{
+    _chunks.clear();
+    _size = 0;
+}
@@ -0,0 +1,42 @@
+#ifndef _BYTE_BUFFER_HPP_
+#define _BYTE_BUFFER_HPP_
+
+#include <vector>
+#include <memory>
+#include <string_view>
+#include <cstddef>
+
+// append-only byte storage in fixed size chunks, addressed by byte offset from the start
+class byte_buffer
+{
+    private:
+
+    static constexpr std::size_t chunk_size = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> _chunks;
+    std::size_t _size;
+
+    public:
+
+    byte_buffer();
+
+    byte_buffer(const byte_buffer& other) = delete;
+    byte_buffer& operator=(const byte_buffer& other) = delete;
+
+    // takes over the chunks, other is left empty
+    byte_buffer(byte_buffer&& other) noexcept;
+
+    std::size_t size() const;
+
+    void append(std::string_view text);
+
+    char& operator[](std::size_t offset);
+    char operator[](std::size_t offset) const;
+
+    // the contents as one view per chunk, valid until the buffer changes
+    std::vector<std::string_view> pieces() const;
+
+    void clear();
+};
+
+#endif
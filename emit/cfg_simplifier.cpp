@@ -0,0 +1,233 @@
+#include "cfg_simplifier.hpp"
+#include "ir_builder.hpp"
+#include <vector>
+
+using std::vector;
+
+// every terminator operand naming the block is one edge into it
+static uint32_t predecessor_count(const ir_basic_block* block)
+{
+    uint32_t count = 0;
+
+    for (ir_use* use = block->uses; use != nullptr; use = use->next)
+    {
+        if (use->user->is_terminator())
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+static ir_basic_block* target(const ir_instruction* branch, uint32_t index)
+{
+    return static_cast<ir_basic_block*>(branch->operand(index));
+}
+
+// index of the first incoming pair of the phi that comes from the block
+static uint32_t incoming_index(const ir_instruction* phi, const ir_basic_block* block)
+{
+    uint32_t index = 0;
+
+    while (phi->operand(index + 1) != block)
+    {
+        index += 2;
+    }
+
+    return index;
+}
+
+cfg_simplifier::cfg_simplifier(ir_builder& builder, ir_function* function): _builder(builder), _function(function)
+{
+}
+
+// a conditional branch with a constant condition or the same target twice becomes a plain branch
+bool cfg_simplifier::fold_branch(ir_basic_block* block)
+{
+    ir_instruction* branch = block->last;
+
+    if (branch == nullptr || branch->opcode != ir_opcode::CondBr)
+    {
+        return false;
+    }
+
+    ir_value* condition = branch->operand(0);
+    ir_basic_block* taken;
+    ir_basic_block* dropped;
+
+    if (condition->value_kind == ir_value_kind::Constant)
+    {
+        bool value = static_cast<ir_constant*>(condition)->value != 0;
+
+        taken = target(branch, value ? 1 : 2);
+        dropped = target(branch, value ? 2 : 1);
+    }
+    else if (target(branch, 1) == target(branch, 2))
+    {
+        taken = target(branch, 1);
+        dropped = taken;
+    }
+    else
+    {
+        return false;
+    }
+
+    for (ir_instruction* phi = dropped->first; phi != nullptr && phi->opcode == ir_opcode::Phi; phi = phi->next)
+    {
+        _builder.remove_incoming(phi, incoming_index(phi, block));
+    }
+
+    block->remove(branch);
+
+    _builder.insert_into(block);
+    _builder.branch(taken);
+
+    return true;
+}
+
+// a block whose only predecessor branches to it unconditionally is appended to that predecessor
+bool cfg_simplifier::merge_successor(ir_basic_block* block)
+{
+    ir_instruction* branch = block->last;
+
+    if (branch == nullptr || branch->opcode != ir_opcode::Br)
+    {
+        return false;
+    }
+
+    ir_basic_block* successor = target(branch, 0);
+
+    if (successor == block || successor == _function->first_block || predecessor_count(successor) != 1)
+    {
+        return false;
+    }
+
+    block->remove(branch);
+
+    while (successor->first != nullptr && successor->first->opcode == ir_opcode::Phi)
+    {
+        ir_instruction* phi = successor->first;
+
+        phi->replace_uses(phi->operand(0));
+        successor->remove(phi);
+    }
+
+    for (ir_instruction* instruction = successor->first; instruction != nullptr; )
+    {
+        ir_instruction* next = instruction->next;
+
+        block->append(instruction);
+        instruction = next;
+    }
+
+    successor->first = nullptr;
+    successor->last = nullptr;
+
+    // what is left are the incoming blocks of phis further on
+    successor->replace_uses(block);
+    _function->remove(successor);
+
+    return true;
+}
+
+// the predecessors of a block holding nothing but a branch jump straight to its target,
+// unless a phi of the target would need two different values on edges from the same predecessor
+bool cfg_simplifier::thread_jump(ir_basic_block* block)
+{
+    ir_instruction* branch = block->first;
+
+    if (block == _function->first_block || branch == nullptr || branch->opcode != ir_opcode::Br)
+    {
+        return false;
+    }
+
+    ir_basic_block* successor = target(branch, 0);
+
+    if (successor == block)
+    {
+        return false;
+    }
+
+    vector<ir_use*> edges;
+
+    for (ir_use* use = block->uses; use != nullptr; use = use->next)
+    {
+        if (use->user->is_terminator())
+        {
+            edges.push_back(use);
+        }
+    }
+
+    if (edges.empty())
+    {
+        return false;
+    }
+
+    for (ir_instruction* phi = successor->first; phi != nullptr && phi->opcode == ir_opcode::Phi; phi = phi->next)
+    {
+        ir_value* value = phi->operand(incoming_index(phi, block));
+
+        for (ir_use* edge : edges)
+        {
+            ir_basic_block* predecessor = edge->user->parent;
+
+            for (uint32_t i = 0; i < phi->operand_count; i += 2)
+            {
+                if (phi->operand(i + 1) == predecessor && phi->operand(i) != value)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    for (ir_instruction* phi = successor->first; phi != nullptr && phi->opcode == ir_opcode::Phi; phi = phi->next)
+    {
+        uint32_t index = incoming_index(phi, block);
+        ir_value* value = phi->operand(index);
+
+        phi->set_operand(index + 1, edges[0]->user->parent);
+
+        for (size_t i = 1; i < edges.size(); i++)
+        {
+            _builder.add_incoming(phi, value, edges[i]->user->parent);
+        }
+    }
+
+    for (ir_use* edge : edges)
+    {
+        edge->user->set_operand(static_cast<uint32_t>(edge - edge->user->operands), successor);
+    }
+
+    block->remove(branch);
+    _function->remove(block);
+
+    return true;
+}
+
+// repeated until nothing changes, a merge or a threaded jump can expose another one
+void cfg_simplifier::run()
+{
+    bool changed = true;
+
+    while (changed)
+    {
+        changed = false;
+
+        for (ir_basic_block* block = _function->first_block; block != nullptr; )
+        {
+            changed |= fold_branch(block);
+
+            while (merge_successor(block))
+            {
+                changed = true;
+            }
+
+            ir_basic_block* next = block->next;
+
+            changed |= thread_jump(block);
+            block = next;
+        }
+    }
+}
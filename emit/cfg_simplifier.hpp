@@ -0,0 +1,33 @@
+#ifndef _CFG_SIMPLIFIER_HPP_
+#define _CFG_SIMPLIFIER_HPP_
+
+#include "ir.hpp"
+#include <cstdint>
+
+class ir_builder;
+
+// cleans up the control flow of a finished function: folds branches with a single outcome,
+// merges a block into its only predecessor and threads jumps through blocks that only branch on.
+// the phis of every successor are kept one incoming pair per edge
+class cfg_simplifier
+{
+    private:
+
+    ir_builder& _builder;
+    ir_function* const _function;
+
+    bool fold_branch(ir_basic_block* block);
+    bool merge_successor(ir_basic_block* block);
+    bool thread_jump(ir_basic_block* block);
+
+    public:
+
+    cfg_simplifier(ir_builder& builder, ir_function* function);
+
+    cfg_simplifier(const cfg_simplifier& other) = delete;
+    cfg_simplifier& operator=(const cfg_simplifier& other) = delete;
+
+    void run();
+};
+
+#endif
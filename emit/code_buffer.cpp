@@ -1,26 +1,25 @@
 #include "code_buffer.hpp"
-#include <list>
+#include "../compilation_context.hpp"
 #include <string>
-#include <sstream>
-#include <iostream>
+#include <utility>
+#include <unistd.h>
 #include <stdexcept>
+#include <algorithm>
 
-using std::list;
 using std::string;
-using std::ifstream;
-using std::stringstream;
+using std::string_view;
 
-bool replace(string& str, const string& from, const string& to);
+static constexpr string_view indentation = "                                                                ";
+static constexpr int indent_width = 4;
 
-code_buffer::code_buffer(): _indent(0), _buffer(), _global_buffer()
+code_buffer::code_buffer(): _indent(0), _buffer(), _global_buffer(), _sink(std::make_unique<descriptor_sink>(STDOUT_FILENO))
 {
 
 }
 
 code_buffer& code_buffer::instance()
 {
-    static code_buffer instance;
-    return instance;
+    return compilation_context::current().code;
 }
 
 void code_buffer::increase_indent()
@@ -38,91 +37,70 @@ void code_buffer::decrease_indent()
     _indent--;
 }
 
-size_t code_buffer::emit(const string& line)
+void code_buffer::append_indent(byte_buffer& buffer, int indent)
 {
-    stringstream instr;
-
-    for (int i = 0; i < _indent; i++)
+    for (size_t width = static_cast<size_t>(indent) * indent_width; width > 0; )
     {
-        instr << "    ";
-    }
+        size_t count = std::min(width, indentation.size());
 
-    instr << line;
+        buffer.append(indentation.substr(0, count));
 
-    _buffer.push_back(instr.str());
-
-    return _buffer.size() - 1;
+        width -= count;
+    }
 }
 
-size_t code_buffer::emit_from(std::istream& stream)
+size_t code_buffer::emit(string_view line)
 {
-    if (stream.fail())
-    {
-        throw std::runtime_error("bad input steam.");
-    }
+    size_t offset = _buffer.size();
 
-    for (string line; std::getline(stream, line); )
-    {
-        emit(line);
-    }
+    begin_line();
+    write(line);
+    end_line();
 
-    return _buffer.size() - 1;
+    return offset;
 }
 
-size_t code_buffer::emit_from_file(std::string path)
+void code_buffer::begin_line()
 {
-    ifstream file;
-
-    file.open(path.c_str());
-
-    return emit_from(file);
+    append_indent(_buffer, _indent);
 }
 
-void code_buffer::backpatch(const list<size_t>& patch_list, const std::string& label)
+void code_buffer::write(string_view text)
 {
-    string to = "%" + label;
-
-    for (auto& line : patch_list)
-    {
-        bool res = replace(_buffer[line], "@", to);
-
-        if (res == false)
-        {
-            std::runtime_error("nothing to backpatch in the patch record");
-        }
-    }
+    _buffer.append(text);
 }
 
-void code_buffer::print() const
+void code_buffer::end_line()
 {
-    for (auto& line : _global_buffer)
-    {
-        std::cout << line << std::endl;
-    }
+    _buffer.append("\n");
+}
 
-    for (auto& line : _buffer)
-    {
-        std::cout << line << std::endl;
-    }
+void code_buffer::set_sink(std::unique_ptr<output_sink> sink)
+{
+    _sink = std::move(sink);
 }
 
-size_t code_buffer::emit_global(const std::string& line)
+void code_buffer::flush()
 {
-    _global_buffer.push_back(line);
+    std::vector<byte_buffer> batch;
 
-    return _global_buffer.size() - 1;
+    batch.push_back(std::move(_global_buffer));
+    batch.push_back(std::move(_buffer));
+
+    _sink->write(batch);
 }
 
-bool replace(string& str, const string& from, const string& to)
+void code_buffer::close()
 {
-    size_t pos = str.find_last_of(from);
+    _sink->close();
+}
 
-    if (pos == string::npos)
-    {
-        return false;
-    }
+size_t code_buffer::emit_global(string_view line)
+{
+    size_t offset = _global_buffer.size();
 
-    str.replace(pos, from.length(), to);
+    _global_buffer.append(line);
+    _global_buffer.append("\n");
 
-    return true;
-}
\ No newline at end of file
+    return offset;
+}
@@ -1,23 +1,29 @@
 #ifndef _BP_HPP_
 #define _BP_HPP_
 
-#include "ir_builder.hpp"
-#include <list>
+#include "ir_format.hpp"
+#include "byte_buffer.hpp"
+#include "output_sink.hpp"
+#include <memory>
 #include <vector>
 #include <string>
-#include <fstream>
-#include <istream>
+#include <string_view>
 
 class code_buffer
 {
     private:
 
     int _indent;
-    std::vector<std::string> _buffer;
-    std::vector<std::string> _global_buffer;
+    byte_buffer _buffer;
+    byte_buffer _global_buffer;
+    std::unique_ptr<output_sink> _sink;
+
+    void append_indent(byte_buffer& buffer, int indent);
 
     code_buffer();
 
+    friend class compilation_context;
+
     public:
 
     code_buffer(code_buffer const&) = delete;
@@ -28,30 +34,46 @@ class code_buffer
     void increase_indent();
     void decrease_indent();
 
-    size_t emit(const std::string& line);
-    size_t emit_global(const std::string& line);
+    size_t emit(std::string_view line);
+    size_t emit_global(std::string_view line);
 
-    size_t emit_from(std::istream& stream);
-    size_t emit_from_file(std::string path);
+    void begin_line();
+    void write(std::string_view text);
+    void end_line();
 
-    void backpatch(const std::list<size_t>& patch_list, const std::string& label);
+    void set_sink(std::unique_ptr<output_sink> sink);
 
-    void print() const;
+    // hands the globals and then the code written so far to the sink
+    void flush();
+    void close();
 
-    template<typename ... Args>
-    size_t emit(const std::string& line, Args ... args)
+    template<typename Text, typename ... Args>
+    size_t emit(ir_format::format<Text> format, const Args& ... args)
     {
-        std::string formatted = ir_builder::format_string(line, args ...);
+        size_t offset = _buffer.size();
 
-        return emit(formatted);
+        begin_line();
+        write(format, args ...);
+        end_line();
+
+        return offset;
     }
 
-    template<typename ... Args>
-    size_t emit_global(const std::string& line, Args ... args)
+    template<typename Text, typename ... Args>
+    void write(ir_format::format<Text> format, const Args& ... args)
     {
-        std::string formatted = ir_builder::format_string(line, args ...);
+        ir_format::write(_buffer, format, args ...);
+    }
+
+    template<typename Text, typename ... Args>
+    size_t emit_global(ir_format::format<Text> format, const Args& ... args)
+    {
+        size_t offset = _global_buffer.size();
+
+        ir_format::write(_global_buffer, format, args ...);
+        _global_buffer.append("\n");
 
-        return emit_global(formatted);
+        return offset;
     }
 };
 
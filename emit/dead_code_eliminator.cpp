@@ -0,0 +1,204 @@
+#include "dead_code_eliminator.hpp"
+#include "ir_builder.hpp"
+
+static bool has_side_effects(const ir_instruction* instruction)
+{
+    return instruction->is_terminator() || instruction->opcode == ir_opcode::Call || instruction->opcode == ir_opcode::Store;
+}
+
+// the only target a conditional branch on a constant can take, null for any other terminator
+static ir_basic_block* taken_target(const ir_instruction* terminator)
+{
+    if (terminator->opcode != ir_opcode::CondBr || terminator->operand(0)->value_kind != ir_value_kind::Constant)
+    {
+        return nullptr;
+    }
+
+    bool condition = static_cast<const ir_constant*>(terminator->operand(0))->value != 0;
+
+    return static_cast<ir_basic_block*>(terminator->operand(condition ? 1 : 2));
+}
+
+dead_code_eliminator::dead_code_eliminator(ir_builder& builder, ir_function* function): _builder(builder), _function(function), _worklist()
+{
+}
+
+void dead_code_eliminator::mark(ir_value* value)
+{
+    if (value->number == 0)
+    {
+        value->number = 1;
+        _worklist.push_back(value);
+    }
+}
+
+// the phis of the successor forget one edge from the block
+void dead_code_eliminator::remove_incoming(ir_basic_block* successor, const ir_basic_block* block)
+{
+    for (ir_instruction* phi = successor->first; phi != nullptr && phi->opcode == ir_opcode::Phi; phi = phi->next)
+    {
+        for (uint32_t i = 0; i < phi->operand_count; i += 2)
+        {
+            if (phi->operand(i + 1) == block)
+            {
+                _builder.remove_incoming(phi, i);
+                break;
+            }
+        }
+    }
+}
+
+void dead_code_eliminator::remove_unreachable_blocks()
+{
+    for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+    {
+        block->number = 0;
+    }
+
+    mark(_function->first_block);
+
+    while (_worklist.empty() == false)
+    {
+        ir_basic_block* block = static_cast<ir_basic_block*>(_worklist.back());
+        _worklist.pop_back();
+
+        ir_instruction* terminator = block->last;
+
+        if (ir_basic_block* target = taken_target(terminator))
+        {
+            mark(target);
+            continue;
+        }
+
+        for (uint32_t i = 0; i < terminator->operand_count; i++)
+        {
+            if (terminator->operand(i)->value_kind == ir_value_kind::Block)
+            {
+                mark(terminator->operand(i));
+            }
+        }
+    }
+
+    // a branch on a constant keeps only the edge it takes
+    for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+    {
+        ir_instruction* terminator = block->last;
+        ir_basic_block* target = block->number != 0 ? taken_target(terminator) : nullptr;
+
+        if (target == nullptr)
+        {
+            continue;
+        }
+
+        ir_basic_block* dropped = static_cast<ir_basic_block*>(terminator->operand(terminator->operand(1) == target ? 2 : 1));
+
+        remove_incoming(dropped, block);
+
+        block->remove(terminator);
+
+        _builder.insert_into(block);
+        _builder.branch(target);
+    }
+
+    // the phis of reachable successors forget the edges first, so only dead code refers to dead code
+    for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+    {
+        if (block->number != 0)
+        {
+            continue;
+        }
+
+        ir_instruction* terminator = block->last;
+
+        for (uint32_t i = 0; i < terminator->operand_count; i++)
+        {
+            ir_value* successor = terminator->operand(i);
+
+            if (successor->value_kind != ir_value_kind::Block || successor->number == 0)
+            {
+                continue;
+            }
+
+            remove_incoming(static_cast<ir_basic_block*>(successor), block);
+        }
+    }
+
+    for (ir_basic_block* block = _function->first_block; block != nullptr; )
+    {
+        ir_basic_block* next = block->next;
+
+        if (block->number == 0)
+        {
+            while (block->first != nullptr)
+            {
+                block->remove(block->first);
+            }
+
+            _function->remove(block);
+        }
+
+        block = next;
+    }
+}
+
+void dead_code_eliminator::remove_dead_instructions()
+{
+    for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+    {
+        for (ir_instruction* instruction = block->first; instruction != nullptr; instruction = instruction->next)
+        {
+            instruction->number = 0;
+        }
+    }
+
+    for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+    {
+        for (ir_instruction* instruction = block->first; instruction != nullptr; instruction = instruction->next)
+        {
+            if (has_side_effects(instruction))
+            {
+                mark(instruction);
+            }
+        }
+    }
+
+    while (_worklist.empty() == false)
+    {
+        ir_instruction* instruction = static_cast<ir_instruction*>(_worklist.back());
+        _worklist.pop_back();
+
+        for (uint32_t i = 0; i < instruction->operand_count; i++)
+        {
+            if (instruction->operand(i)->value_kind == ir_value_kind::Instruction)
+            {
+                mark(instruction->operand(i));
+            }
+        }
+    }
+
+    for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+    {
+        for (ir_instruction* instruction = block->first; instruction != nullptr; )
+        {
+            ir_instruction* next = instruction->next;
+
+            // a callee is only referenced by the calls that survive
+            if (instruction->number == 0)
+            {
+                block->remove(instruction);
+            }
+            else if (instruction->opcode == ir_opcode::Call)
+            {
+                instruction->callee->referenced = true;
+            }
+
+            instruction = next;
+        }
+    }
+}
+
+void dead_code_eliminator::run()
+{
+    remove_unreachable_blocks();
+    remove_dead_instructions();
+}
@@ -0,0 +1,36 @@
+#ifndef _DEAD_CODE_ELIMINATOR_HPP_
+#define _DEAD_CODE_ELIMINATOR_HPP_
+
+#include "ir.hpp"
+#include <vector>
+
+class ir_builder;
+
+// drops the blocks no path from the entry reaches, a branch on a constant only reaches the target it takes.
+// then drops every instruction whose value never reaches a call, store or terminator,
+// and marks the callees of the calls left as referenced.
+// the number of a value is used as the mark until printing assigns it
+class dead_code_eliminator
+{
+    private:
+
+    ir_builder& _builder;
+    ir_function* const _function;
+    std::vector<ir_value*> _worklist;
+
+    void mark(ir_value* value);
+    void remove_incoming(ir_basic_block* successor, const ir_basic_block* block);
+    void remove_unreachable_blocks();
+    void remove_dead_instructions();
+
+    public:
+
+    dead_code_eliminator(ir_builder& builder, ir_function* function);
+
+    dead_code_eliminator(const dead_code_eliminator& other) = delete;
+    dead_code_eliminator& operator=(const dead_code_eliminator& other) = delete;
+
+    void run();
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "definition_table.hpp"
+#include <algorithm>
+
+static constexpr unsigned initial_bits = 8;
+
+definition_table::definition_table(): _entries(std::size_t(1) << initial_bits, entry{ nullptr, 0, 0, nullptr }), _count(0), _generation(1), _shift(64 - initial_bits)
+{
+}
+
+// fibonacci hashing, the top bits of the product pick the first probe
+std::size_t definition_table::position(const ir_basic_block* block, uint32_t slot) const
+{
+    uint64_t key = reinterpret_cast<uintptr_t>(block) ^ (static_cast<uint64_t>(slot) << 40);
+
+    return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ull) >> _shift);
+}
+
+ir_value* definition_table::find(const ir_basic_block* block, uint32_t slot) const
+{
+    std::size_t mask = _entries.size() - 1;
+
+    for (std::size_t i = position(block, slot); ; i = (i + 1) & mask)
+    {
+        const entry& current = _entries[i];
+
+        if (current.generation != _generation)
+        {
+            return nullptr;
+        }
+
+        if (current.block == block && current.slot == slot)
+        {
+            return current.value;
+        }
+    }
+}
+
+void definition_table::set(const ir_basic_block* block, uint32_t slot, ir_value* value)
+{
+    if ((_count + 1) * 2 > _entries.size())
+    {
+        grow();
+    }
+
+    std::size_t mask = _entries.size() - 1;
+
+    for (std::size_t i = position(block, slot); ; i = (i + 1) & mask)
+    {
+        entry& current = _entries[i];
+
+        if (current.generation != _generation)
+        {
+            current = entry{ block, slot, _generation, value };
+            _count++;
+            return;
+        }
+
+        if (current.block == block && current.slot == slot)
+        {
+            current.value = value;
+            return;
+        }
+    }
+}
+
+void definition_table::grow()
+{
+    std::vector<entry> entries(_entries.size() * 2, entry{ nullptr, 0, 0, nullptr });
+
+    std::swap(entries, _entries);
+
+    uint32_t generation = _generation;
+
+    _count = 0;
+    _shift--;
+    _generation = 1;
+
+    for (const entry& moved : entries)
+    {
+        if (moved.generation == generation)
+        {
+            set(moved.block, moved.slot, moved.value);
+        }
+    }
+}
+
+void definition_table::clear()
+{
+    _count = 0;
+
+    // a wrapped generation would revive entries of a function long gone
+    if (++_generation == 0)
+    {
+        std::fill(_entries.begin(), _entries.end(), entry{ nullptr, 0, 0, nullptr });
+        _generation = 1;
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef _DEFINITION_TABLE_HPP_
+#define _DEFINITION_TABLE_HPP_
+
+#include "ir.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// maps a block and a local's slot to the local's value at the end of the block.
+// open addressing without per entry allocations, entries of an older generation count as empty so clearing is constant time
+class definition_table
+{
+    private:
+
+    struct entry
+    {
+        const ir_basic_block* block;
+        uint32_t slot;
+        uint32_t generation;
+        ir_value* value;
+    };
+
+    std::vector<entry> _entries;
+    std::size_t _count;
+    uint32_t _generation;
+    unsigned _shift;
+
+    std::size_t position(const ir_basic_block* block, uint32_t slot) const;
+    void grow();
+
+    public:
+
+    definition_table();
+
+    definition_table(const definition_table& other) = delete;
+    definition_table& operator=(const definition_table& other) = delete;
+
+    // returns nullptr when the local is not defined in the block
+    ir_value* find(const ir_basic_block* block, uint32_t slot) const;
+    void set(const ir_basic_block* block, uint32_t slot, ir_value* value);
+
+    void clear();
+};
+
+#endif
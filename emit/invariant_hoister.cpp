@@ -0,0 +1,267 @@
+#include "invariant_hoister.hpp"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+using std::pair;
+using std::vector;
+
+static constexpr uint32_t unvisited = std::numeric_limits<uint32_t>::max();
+
+// pure and unable to trap, so running it once before the loop is the same as running it on every iteration
+static bool movable(const ir_instruction* instruction)
+{
+    switch (instruction->opcode)
+    {
+        case ir_opcode::Add:
+        case ir_opcode::Sub:
+        case ir_opcode::Mul:
+        case ir_opcode::And:
+        case ir_opcode::ZExt:
+        case ir_opcode::Trunc:
+        case ir_opcode::ICmp:
+        case ir_opcode::Select:
+        case ir_opcode::ElementPointer:
+            return true;
+
+        default: return false;
+    }
+}
+
+invariant_hoister::invariant_hoister(ir_function* function): _function(function), _order(), _dominators(), _stamps()
+{
+}
+
+void invariant_hoister::order_blocks()
+{
+    for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+    {
+        block->number = unvisited;
+    }
+
+    vector<pair<ir_basic_block*, uint32_t>> stack = { { _function->first_block, 0 } };
+    _function->first_block->number = 0;
+
+    _order.clear();
+
+    while (stack.empty() == false)
+    {
+        ir_basic_block* block = stack.back().first;
+        uint32_t index = stack.back().second;
+        ir_instruction* terminator = block->last;
+
+        if (index == terminator->operand_count)
+        {
+            _order.push_back(block);
+            stack.pop_back();
+            continue;
+        }
+
+        stack.back().second++;
+
+        ir_value* successor = terminator->operand(index);
+
+        if (successor->value_kind == ir_value_kind::Block && successor->number == unvisited)
+        {
+            successor->number = 0;
+            stack.push_back({ static_cast<ir_basic_block*>(successor), 0 });
+        }
+    }
+
+    std::reverse(_order.begin(), _order.end());
+
+    for (uint32_t i = 0; i < _order.size(); i++)
+    {
+        _order[i]->number = i;
+    }
+}
+
+// Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm"
+void invariant_hoister::find_dominators()
+{
+    _dominators.assign(_order.size(), unvisited);
+    _dominators[0] = 0;
+
+    bool changed = true;
+
+    while (changed)
+    {
+        changed = false;
+
+        for (uint32_t i = 1; i < _order.size(); i++)
+        {
+            uint32_t dominator = unvisited;
+
+            for (ir_use* use = _order[i]->uses; use != nullptr; use = use->next)
+            {
+                if (use->user->is_terminator() == false)
+                {
+                    continue;
+                }
+
+                uint32_t predecessor = use->user->parent->number;
+
+                if (predecessor == unvisited || _dominators[predecessor] == unvisited)
+                {
+                    continue;
+                }
+
+                if (dominator == unvisited)
+                {
+                    dominator = predecessor;
+                    continue;
+                }
+
+                while (predecessor != dominator)
+                {
+                    while (predecessor > dominator) predecessor = _dominators[predecessor];
+                    while (dominator > predecessor) dominator = _dominators[dominator];
+                }
+            }
+
+            if (_dominators[i] != dominator)
+            {
+                _dominators[i] = dominator;
+                changed = true;
+            }
+        }
+    }
+}
+
+// a dominator comes before the blocks it dominates in reverse postorder
+bool invariant_hoister::dominates(uint32_t dominator, uint32_t block) const
+{
+    while (block > dominator)
+    {
+        block = _dominators[block];
+    }
+
+    return block == dominator;
+}
+
+// the body of a loop is every block that reaches a branch back to the header without passing the header
+vector<invariant_hoister::loop> invariant_hoister::find_loops()
+{
+    vector<loop> loops;
+    vector<ir_basic_block*> pending;
+
+    _stamps.assign(_order.size(), 0);
+
+    for (uint32_t i = 0; i < _order.size(); i++)
+    {
+        ir_basic_block* header = _order[i];
+        uint32_t stamp = static_cast<uint32_t>(loops.size()) + 1;
+
+        for (ir_use* use = header->uses; use != nullptr; use = use->next)
+        {
+            if (use->user->is_terminator() && dominates(i, use->user->parent->number))
+            {
+                pending.push_back(use->user->parent);
+            }
+        }
+
+        if (pending.empty())
+        {
+            continue;
+        }
+
+        loop current = { header, { header } };
+        _stamps[i] = stamp;
+
+        while (pending.empty() == false)
+        {
+            ir_basic_block* block = pending.back();
+            pending.pop_back();
+
+            if (_stamps[block->number] == stamp)
+            {
+                continue;
+            }
+
+            _stamps[block->number] = stamp;
+            current.body.push_back(block);
+
+            for (ir_use* use = block->uses; use != nullptr; use = use->next)
+            {
+                if (use->user->is_terminator() && _stamps[use->user->parent->number] != stamp)
+                {
+                    pending.push_back(use->user->parent);
+                }
+            }
+        }
+
+        std::sort(current.body.begin(), current.body.end(), [](const ir_basic_block* left, const ir_basic_block* right) { return left->number < right->number; });
+
+        loops.push_back(std::move(current));
+    }
+
+    return loops;
+}
+
+// a loop entered from more than one block outside of it is left alone
+void invariant_hoister::hoist(const loop& current, uint32_t stamp)
+{
+    for (ir_basic_block* block : current.body)
+    {
+        _stamps[block->number] = stamp;
+    }
+
+    ir_basic_block* preheader = nullptr;
+    uint32_t entries = 0;
+
+    for (ir_use* use = current.header->uses; use != nullptr; use = use->next)
+    {
+        if (use->user->is_terminator() && _stamps[use->user->parent->number] != stamp)
+        {
+            preheader = use->user->parent;
+            entries++;
+        }
+    }
+
+    if (entries != 1 || preheader->last->opcode != ir_opcode::Br)
+    {
+        return;
+    }
+
+    // in reverse postorder the operands inside the loop are visited, and possibly hoisted, before their users
+    for (ir_basic_block* block : current.body)
+    {
+        for (ir_instruction* instruction = block->first; instruction != nullptr; )
+        {
+            ir_instruction* next = instruction->next;
+            bool invariant = movable(instruction);
+
+            for (uint32_t i = 0; invariant && i < instruction->operand_count; i++)
+            {
+                const ir_value* operand = instruction->operand(i);
+
+                invariant = operand->value_kind != ir_value_kind::Instruction || _stamps[static_cast<const ir_instruction*>(operand)->parent->number] != stamp;
+            }
+
+            if (invariant)
+            {
+                block->unlink(instruction);
+                preheader->insert_before(preheader->last, instruction);
+            }
+
+            instruction = next;
+        }
+    }
+}
+
+void invariant_hoister::run()
+{
+    order_blocks();
+    find_dominators();
+
+    vector<loop> loops = find_loops();
+
+    std::sort(loops.begin(), loops.end(), [](const loop& left, const loop& right) { return left.body.size() < right.body.size(); });
+
+    uint32_t stamp = static_cast<uint32_t>(loops.size());
+
+    for (const loop& current : loops)
+    {
+        hoist(current, ++stamp);
+    }
+}
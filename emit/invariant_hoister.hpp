@@ -0,0 +1,43 @@
+#ifndef _INVARIANT_HOISTER_HPP_
+#define _INVARIANT_HOISTER_HPP_
+
+#include "ir.hpp"
+#include <cstdint>
+#include <vector>
+
+// moves pure instructions whose operands do not change inside a loop to the block that enters the loop,
+// so a division check on an invariant divisor compares once instead of on every iteration.
+// loops are found from the dominator tree, inner loops are handled first so their hoisted code can move on outwards
+class invariant_hoister
+{
+    private:
+
+    struct loop
+    {
+        ir_basic_block* header;
+        std::vector<ir_basic_block*> body;
+    };
+
+    ir_function* const _function;
+    // blocks in reverse postorder, a block's number is its position
+    std::vector<ir_basic_block*> _order;
+    std::vector<uint32_t> _dominators;
+    std::vector<uint32_t> _stamps;
+
+    void order_blocks();
+    void find_dominators();
+    bool dominates(uint32_t dominator, uint32_t block) const;
+    std::vector<loop> find_loops();
+    void hoist(const loop& current, uint32_t stamp);
+
+    public:
+
+    explicit invariant_hoister(ir_function* function);
+
+    invariant_hoister(const invariant_hoister& other) = delete;
+    invariant_hoister& operator=(const invariant_hoister& other) = delete;
+
+    void run();
+};
+
+#endif
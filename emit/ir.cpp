@@ -0,0 +1,443 @@
+#include "ir.hpp"
+#include "../compilation_context.hpp"
+#include <algorithm>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+static void link_use(ir_use& use, ir_value* value)
+{
+    use.value = value;
+    use.previous = &value->uses;
+    use.next = value->uses;
+
+    if (use.next != nullptr)
+    {
+        use.next->previous = &use.next;
+    }
+
+    value->uses = &use;
+}
+
+static void unlink_use(ir_use& use)
+{
+    if (use.value == nullptr)
+    {
+        return;
+    }
+
+    *use.previous = use.next;
+
+    if (use.next != nullptr)
+    {
+        use.next->previous = use.previous;
+    }
+
+    use.value = nullptr;
+    use.next = nullptr;
+    use.previous = nullptr;
+}
+
+ir_value::ir_value(ir_value_kind value_kind, ir_type type, uint32_t number): value_kind(value_kind), type(type), number(number), uses(nullptr)
+{
+}
+
+void* ir_value::operator new(std::size_t size, arena& storage)
+{
+    return storage.allocate(size);
+}
+
+void ir_value::operator delete(void*, arena&)
+{
+}
+
+void ir_value::operator delete(void*)
+{
+}
+
+bool ir_value::used() const
+{
+    return uses != nullptr;
+}
+
+void ir_value::replace_uses(ir_value* replacement)
+{
+    while (uses != nullptr)
+    {
+        ir_use* use = uses;
+
+        unlink_use(*use);
+        link_use(*use, replacement);
+    }
+}
+
+ir_constant::ir_constant(ir_type type, long long value): ir_value(ir_value_kind::Constant, type, 0), value(value)
+{
+}
+
+ir_undefined::ir_undefined(ir_type type): ir_value(ir_value_kind::Undefined, type, 0)
+{
+}
+
+ir_argument::ir_argument(ir_type type, uint32_t index): ir_value(ir_value_kind::Argument, type, index)
+{
+}
+
+ir_global::ir_global(uint32_t number, string_view name, string_view content): ir_value(ir_value_kind::Global, ir_type::I8Ptr, number), name(name), content(content)
+{
+}
+
+// \\ is a backslash and \XX a hex byte, anything else is taken as is
+string ir_global::bytes() const
+{
+    auto hex = [](char c) -> int
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+        return -1;
+    };
+
+    string bytes;
+
+    for (size_t i = 0; i < content.size(); i++)
+    {
+        if (content[i] == '\\' && i + 1 < content.size() && content[i + 1] == '\\')
+        {
+            bytes.push_back('\\');
+            i++;
+        }
+        else if (content[i] == '\\' && i + 2 < content.size() && hex(content[i + 1]) >= 0 && hex(content[i + 2]) >= 0)
+        {
+            bytes.push_back(static_cast<char>(hex(content[i + 1]) * 16 + hex(content[i + 2])));
+            i += 2;
+        }
+        else
+        {
+            bytes.push_back(content[i]);
+        }
+    }
+
+    return bytes;
+}
+
+ir_instruction::ir_instruction(ir_opcode opcode, ir_type type, ir_predicate predicate):
+    ir_value(ir_value_kind::Instruction, type, 0), opcode(opcode), predicate(predicate), allocated_type(ir_type::Void), callee(nullptr),
+    parent(nullptr), previous(nullptr), next(nullptr), operands(nullptr), operand_count(0), operand_capacity(0)
+{
+}
+
+ir_value* ir_instruction::operand(uint32_t index) const
+{
+    return operands[index].value;
+}
+
+void ir_instruction::set_operand(uint32_t index, ir_value* value)
+{
+    ir_use& use = operands[index];
+
+    unlink_use(use);
+
+    use.user = this;
+
+    if (value != nullptr)
+    {
+        link_use(use, value);
+    }
+}
+
+// the use lists hold pointers into the old slots, so every linked use is re-pointed at its new slot
+void ir_instruction::move_operands(ir_use* storage, uint32_t capacity)
+{
+    for (uint32_t i = 0; i < operand_count; i++)
+    {
+        ir_use& moved = storage[i];
+
+        moved = operands[i];
+
+        if (moved.value == nullptr)
+        {
+            continue;
+        }
+
+        *moved.previous = &moved;
+
+        if (moved.next != nullptr)
+        {
+            moved.next->previous = &moved.next;
+        }
+    }
+
+    for (uint32_t i = operand_count; i < capacity; i++)
+    {
+        storage[i] = { nullptr, this, nullptr, nullptr };
+    }
+
+    operands = storage;
+    operand_capacity = capacity;
+}
+
+bool ir_instruction::is_terminator() const
+{
+    return opcode == ir_opcode::Br || opcode == ir_opcode::CondBr || opcode == ir_opcode::Ret || opcode == ir_opcode::Unreachable;
+}
+
+ir_basic_block::ir_basic_block(ir_function* parent):
+    ir_value(ir_value_kind::Block, ir_type::Label, 0), parent(parent), first(nullptr), last(nullptr), previous(nullptr), next(nullptr)
+{
+}
+
+bool ir_basic_block::terminated() const
+{
+    return last != nullptr && last->is_terminator();
+}
+
+void ir_basic_block::append(ir_instruction* instruction)
+{
+    instruction->parent = this;
+    instruction->previous = last;
+    instruction->next = nullptr;
+
+    if (last == nullptr)
+    {
+        first = instruction;
+    }
+    else
+    {
+        last->next = instruction;
+    }
+
+    last = instruction;
+}
+
+void ir_basic_block::prepend(ir_instruction* instruction)
+{
+    instruction->parent = this;
+    instruction->previous = nullptr;
+    instruction->next = first;
+
+    if (first == nullptr)
+    {
+        last = instruction;
+    }
+    else
+    {
+        first->previous = instruction;
+    }
+
+    first = instruction;
+}
+
+void ir_basic_block::insert_after(ir_instruction* position, ir_instruction* instruction)
+{
+    instruction->parent = this;
+    instruction->previous = position;
+    instruction->next = position->next;
+
+    if (position->next == nullptr)
+    {
+        last = instruction;
+    }
+    else
+    {
+        position->next->previous = instruction;
+    }
+
+    position->next = instruction;
+}
+
+void ir_basic_block::insert_before(ir_instruction* position, ir_instruction* instruction)
+{
+    if (position->previous == nullptr)
+    {
+        prepend(instruction);
+    }
+    else
+    {
+        insert_after(position->previous, instruction);
+    }
+}
+
+void ir_basic_block::remove(ir_instruction* instruction)
+{
+    for (uint32_t i = 0; i < instruction->operand_count; i++)
+    {
+        instruction->set_operand(i, nullptr);
+    }
+
+    unlink(instruction);
+}
+
+void ir_basic_block::unlink(ir_instruction* instruction)
+{
+    if (instruction->previous == nullptr)
+    {
+        first = instruction->next;
+    }
+    else
+    {
+        instruction->previous->next = instruction->next;
+    }
+
+    if (instruction->next == nullptr)
+    {
+        last = instruction->previous;
+    }
+    else
+    {
+        instruction->next->previous = instruction->previous;
+    }
+
+    instruction->parent = nullptr;
+    instruction->previous = nullptr;
+    instruction->next = nullptr;
+}
+
+ir_function::ir_function(string_view name, ir_type return_type, const vector<ir_type>& parameter_types, bool variadic):
+    name(name), return_type(return_type), parameter_types(parameter_types), variadic(variadic), referenced(false), arguments(nullptr), first_block(nullptr), last_block(nullptr)
+{
+}
+
+bool ir_function::defined() const
+{
+    return first_block != nullptr;
+}
+
+void ir_function::append(ir_basic_block* block)
+{
+    block->previous = last_block;
+    block->next = nullptr;
+
+    if (last_block == nullptr)
+    {
+        first_block = block;
+    }
+    else
+    {
+        last_block->next = block;
+    }
+
+    last_block = block;
+}
+
+void ir_function::remove(ir_basic_block* block)
+{
+    if (block->previous == nullptr)
+    {
+        first_block = block->next;
+    }
+    else
+    {
+        block->previous->next = block->next;
+    }
+
+    if (block->next == nullptr)
+    {
+        last_block = block->previous;
+    }
+    else
+    {
+        block->next->previous = block->previous;
+    }
+
+    block->previous = nullptr;
+    block->next = nullptr;
+}
+
+void ir_function::clear_body()
+{
+    arguments = nullptr;
+    first_block = nullptr;
+    last_block = nullptr;
+}
+
+ir_module::ir_module(): _functions(), _by_name(), _declarations(), _definitions(), _globals()
+{
+}
+
+ir_module& ir_module::instance()
+{
+    return compilation_context::current().module;
+}
+
+ir_function* ir_module::function(string_view name) const
+{
+    auto found = _by_name.find(name);
+
+    return found == _by_name.end() ? nullptr : found->second;
+}
+
+ir_function* ir_module::declare_function(string_view name, ir_type return_type, const vector<ir_type>& parameter_types, bool variadic)
+{
+    ir_function* existing = function(name);
+
+    if (existing != nullptr)
+    {
+        return existing;
+    }
+
+    _functions.push_back(std::make_unique<ir_function>(name, return_type, parameter_types, variadic));
+
+    ir_function* declared = _functions.back().get();
+
+    _by_name.emplace(name, declared);
+
+    return declared;
+}
+
+void ir_module::add_declaration(ir_function* function)
+{
+    _declarations.push_back(function);
+}
+
+void ir_module::add_definition(ir_function* function)
+{
+    _definitions.push_back(function);
+}
+
+void ir_module::add_global(ir_global* global)
+{
+    _globals.push_back(global);
+}
+
+// a string only dead code pointed at is left out of the module, the globals from first on are swept
+void ir_module::remove_unused_globals(std::size_t first)
+{
+    auto kept = std::remove_if(_globals.begin() + static_cast<std::ptrdiff_t>(first), _globals.end(), [](const ir_global* global) { return global->uses == nullptr; });
+
+    _globals.erase(kept, _globals.end());
+}
+
+const vector<std::unique_ptr<ir_function>>& ir_module::functions() const
+{
+    return _functions;
+}
+
+const vector<ir_function*>& ir_module::declarations() const
+{
+    return _declarations;
+}
+
+const vector<ir_function*>& ir_module::definitions() const
+{
+    return _definitions;
+}
+
+const vector<ir_global*>& ir_module::globals() const
+{
+    return _globals;
+}
+
+void ir_module::clear_bodies()
+{
+    for (ir_function* function : _definitions)
+    {
+        function->clear_body();
+    }
+
+    _declarations.clear();
+    _definitions.clear();
+    _globals.clear();
+}
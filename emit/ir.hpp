@@ -0,0 +1,218 @@
+#ifndef _IR_HPP_
+#define _IR_HPP_
+
+#include "../memory/arena.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+
+// Pointer is the address of a stack slot, I8Ptr is a string
+enum class ir_type : uint8_t { Void, I1, I8, I32, I8Ptr, Pointer, Label };
+
+enum class ir_value_kind : uint8_t { Constant, Undefined, Argument, Global, Block, Instruction };
+
+enum class ir_opcode : uint8_t
+{
+    Add, Sub, Mul, SDiv, UDiv, And,
+    ZExt, Trunc,
+    ICmp, Select, Phi,
+    Alloca, Load, Store, ElementPointer,
+    Call,
+    Br, CondBr, Ret, Unreachable
+};
+
+enum class ir_predicate : uint8_t { None, Eq, Ne, Sgt, Sge, Slt, Sle, Ugt, Uge, Ult, Ule };
+
+class ir_value;
+class ir_instruction;
+class ir_basic_block;
+class ir_function;
+
+// an operand slot, linked into the use list of the value it refers to
+struct ir_use
+{
+    ir_value* value;
+    ir_instruction* user;
+    ir_use* next;
+    ir_use** previous;
+};
+
+// values live in the builder's arena and are never destroyed individually
+class ir_value
+{
+    public:
+
+    const ir_value_kind value_kind;
+    const ir_type type;
+    // assigned per function when the function is printed
+    uint32_t number;
+    ir_use* uses;
+
+    ir_value(const ir_value& other) = delete;
+    ir_value& operator=(const ir_value& other) = delete;
+
+    static void* operator new(std::size_t size, arena& storage);
+    static void operator delete(void* pointer, arena& storage);
+    static void operator delete(void* pointer);
+
+    bool used() const;
+    void replace_uses(ir_value* replacement);
+
+    protected:
+
+    ir_value(ir_value_kind value_kind, ir_type type, uint32_t number);
+};
+
+class ir_constant final: public ir_value
+{
+    public:
+
+    const long long value;
+
+    ir_constant(ir_type type, long long value);
+};
+
+// what a local holds on a path that never assigned it, LLVM's undef
+class ir_undefined final: public ir_value
+{
+    public:
+
+    explicit ir_undefined(ir_type type);
+};
+
+class ir_argument final: public ir_value
+{
+    public:
+
+    ir_argument(ir_type type, uint32_t index);
+};
+
+// a private string constant, content is escaped as in an LLVM c"" literal and excludes the terminating zero
+class ir_global final: public ir_value
+{
+    public:
+
+    const std::string_view name;
+    const std::string_view content;
+
+    ir_global(uint32_t number, std::string_view name, std::string_view content);
+
+    std::string bytes() const;
+};
+
+class ir_instruction final: public ir_value
+{
+    public:
+
+    const ir_opcode opcode;
+    const ir_predicate predicate;
+    ir_type allocated_type;
+    ir_function* callee;
+    ir_basic_block* parent;
+    ir_instruction* previous;
+    ir_instruction* next;
+    ir_use* operands;
+    uint32_t operand_count;
+    uint32_t operand_capacity;
+
+    ir_instruction(ir_opcode opcode, ir_type type, ir_predicate predicate = ir_predicate::None);
+
+    ir_value* operand(uint32_t index) const;
+    void set_operand(uint32_t index, ir_value* value);
+    void move_operands(ir_use* storage, uint32_t capacity);
+
+    bool is_terminator() const;
+};
+
+class ir_basic_block final: public ir_value
+{
+    public:
+
+    ir_function* const parent;
+    ir_instruction* first;
+    ir_instruction* last;
+    ir_basic_block* previous;
+    ir_basic_block* next;
+
+    explicit ir_basic_block(ir_function* parent);
+
+    bool terminated() const;
+    void append(ir_instruction* instruction);
+    void prepend(ir_instruction* instruction);
+    void insert_after(ir_instruction* position, ir_instruction* instruction);
+    void insert_before(ir_instruction* position, ir_instruction* instruction);
+
+    // unlinks the instruction and drops its operands, its parent is reset to mark it removed
+    void remove(ir_instruction* instruction);
+    // unlinks the instruction but keeps its operands, for moving it to another position
+    void unlink(ir_instruction* instruction);
+};
+
+// the signature outlives a streamed body, arguments and blocks are released with it
+class ir_function
+{
+    public:
+
+    const std::string_view name;
+    const ir_type return_type;
+    const std::vector<ir_type> parameter_types;
+    const bool variadic;
+    bool referenced;
+    ir_argument** arguments;
+    ir_basic_block* first_block;
+    ir_basic_block* last_block;
+
+    ir_function(std::string_view name, ir_type return_type, const std::vector<ir_type>& parameter_types, bool variadic);
+
+    ir_function(const ir_function& other) = delete;
+    ir_function& operator=(const ir_function& other) = delete;
+
+    bool defined() const;
+    void append(ir_basic_block* block);
+    void remove(ir_basic_block* block);
+    void clear_body();
+};
+
+class ir_module
+{
+    private:
+
+    std::vector<std::unique_ptr<ir_function>> _functions;
+    std::unordered_map<std::string_view, ir_function*> _by_name;
+    std::vector<ir_function*> _declarations;
+    std::vector<ir_function*> _definitions;
+    std::vector<ir_global*> _globals;
+
+    ir_module();
+
+    friend class compilation_context;
+
+    public:
+
+    ir_module(const ir_module& other) = delete;
+    ir_module& operator=(const ir_module& other) = delete;
+
+    static ir_module& instance();
+
+    ir_function* function(std::string_view name) const;
+    ir_function* declare_function(std::string_view name, ir_type return_type, const std::vector<ir_type>& parameter_types, bool variadic = false);
+
+    void add_declaration(ir_function* function);
+    void add_definition(ir_function* function);
+    void add_global(ir_global* global);
+    void remove_unused_globals(std::size_t first);
+
+    const std::vector<std::unique_ptr<ir_function>>& functions() const;
+    const std::vector<ir_function*>& declarations() const;
+    const std::vector<ir_function*>& definitions() const;
+    const std::vector<ir_global*>& globals() const;
+
+    // drops the bodies, declarations and globals once they are printed, the signatures stay for later calls
+    void clear_bodies();
+};
+
+#endif
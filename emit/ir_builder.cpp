@@ -1,80 +1,903 @@
 #include "ir_builder.hpp"
+#include "cfg_simplifier.hpp"
+#include "dead_code_eliminator.hpp"
+#include "invariant_hoister.hpp"
+#include "range_analysis.hpp"
+#include "../compilation_context.hpp"
+#include <cstdint>
 #include <string>
+#include <tuple>
 #include <stdexcept>
 
 using std::string;
+using std::string_view;
+using std::vector;
 
-string ir_builder::fresh_register()
+ir_builder::ir_builder(compilation_context& context, arena& storage, ir_module& module):
+    _context(context), _storage(storage), _module(module), _function(nullptr), _block(nullptr), _memory_locals(false), _last_allocation(nullptr), _first_global(0), _slots(), _definitions(),
+    _incomplete_phis(), _replaced()
 {
-    static unsigned long long count = 0;
+}
+
+ir_builder& ir_builder::instance()
+{
+    return compilation_context::current().builder;
+}
+
+ir_type ir_builder::get_ir_type(type_kind data_type)
+{
+    switch (data_type)
+    {
+        case type_kind::Bool: return ir_type::I1;
+        case type_kind::Byte: return ir_type::I8;
+        case type_kind::Int: return ir_type::I32;
+        case type_kind::String: return ir_type::I8Ptr;
+        case type_kind::Void: return ir_type::Void;
+
+        default: throw std::runtime_error("invalid data_type");
+    }
+}
+
+ir_opcode ir_builder::get_bin_inst(arithmetic_operator oper, bool is_signed)
+{
+    switch (oper)
+    {
+        case arithmetic_operator::Add: return ir_opcode::Add;
+        case arithmetic_operator::Sub: return ir_opcode::Sub;
+        case arithmetic_operator::Mul: return ir_opcode::Mul;
+        case arithmetic_operator::Div: return is_signed ? ir_opcode::SDiv : ir_opcode::UDiv;
+
+        default: throw std::runtime_error("unknown oper");
+    }
+}
+
+ir_predicate ir_builder::get_comp_kind(relational_operator oper, bool is_signed)
+{
+    switch (oper)
+    {
+        case relational_operator::Equal: return ir_predicate::Eq;
+        case relational_operator::NotEqual: return ir_predicate::Ne;
+        case relational_operator::Greater: return is_signed ? ir_predicate::Sgt : ir_predicate::Ugt;
+        case relational_operator::GreaterEqual: return is_signed ? ir_predicate::Sge : ir_predicate::Uge;
+        case relational_operator::Less: return is_signed ? ir_predicate::Slt : ir_predicate::Ult;
+        case relational_operator::LessEqual: return is_signed ? ir_predicate::Sle : ir_predicate::Ule;
+
+        default: throw std::runtime_error("unknown oper");
+    }
+}
 
-    string reg = ir_builder::format_string("%%reg_%llu", count);
+ir_function* ir_builder::declare_function(string_view name, type_kind return_type, const vector<type_kind>& parameter_types)
+{
+    vector<ir_type> types;
 
-    count++;
+    for (type_kind type : parameter_types)
+    {
+        types.push_back(get_ir_type(type));
+    }
 
-    return reg;
+    return _module.declare_function(name, get_ir_type(return_type), types);
 }
 
-string ir_builder::fresh_label()
+void ir_builder::begin_function(ir_function* function)
 {
-    static unsigned long long count = 0;
+    uint32_t parameter_count = static_cast<uint32_t>(function->parameter_types.size());
+
+    _function = function;
+    _function->arguments = static_cast<ir_argument**>(_storage.allocate(sizeof(ir_argument*) * parameter_count, alignof(ir_argument*)));
 
-    string label = ir_builder::format_string("label_%llu", count);
+    _block = nullptr;
+    _memory_locals = _context.memory_locals();
+    _last_allocation = nullptr;
+    _first_global = _module.globals().size();
+    _slots.clear();
+    _definitions.clear();
+    _incomplete_phis.clear();
+    _replaced.clear();
 
-    count++;
+    place(create_block());
 
-    return label;
+    for (uint32_t i = 0; i < parameter_count; i++)
+    {
+        _function->arguments[i] = new (_storage) ir_argument(function->parameter_types[i], i);
+    }
+
+    _module.add_definition(function);
 }
 
-std::string ir_builder::fresh_global()
+void ir_builder::end_function()
 {
-    static unsigned long long count = 0;
+    range_analysis(*this, _function).run();
+    dead_code_eliminator(*this, _function).run();
+    invariant_hoister(_function).run();
+    cfg_simplifier(*this, _function).run();
 
-    string label = ir_builder::format_string("@.global_var_%llu", count);
+    _module.remove_unused_globals(_first_global);
 
-    count++;
+    _function = nullptr;
+    _block = nullptr;
+}
 
-    return label;
+ir_basic_block* ir_builder::create_block()
+{
+    return new (_storage) ir_basic_block(_function);
 }
 
-string ir_builder::get_ir_type(type_kind data_type)
+// an unterminated block falls through into the placed one
+void ir_builder::place(ir_basic_block* block)
 {
-    switch (data_type)
+    if (_block != nullptr && _block->terminated() == false)
     {
-        case type_kind::Bool: return "i1";
-        case type_kind::Byte: return "i32";
-        case type_kind::Int: return "i32";
-        case type_kind::String: return "i8*";
-        case type_kind::Void: return "void";
+        branch(block);
+    }
 
-        default: throw std::runtime_error("invalid data_type");
+    _function->append(block);
+    _block = block;
+}
+
+// a loop header gets its back edges only after the body is emitted
+void ir_builder::place_unsealed(ir_basic_block* block)
+{
+    place(block);
+
+    _incomplete_phis.emplace(block, vector<std::pair<uint32_t, ir_instruction*>>());
+}
+
+void ir_builder::seal(ir_basic_block* block)
+{
+    auto found = _incomplete_phis.find(block);
+
+    if (found == _incomplete_phis.end())
+    {
+        return;
+    }
+
+    vector<std::pair<uint32_t, ir_instruction*>> phis = std::move(found->second);
+
+    _incomplete_phis.erase(found);
+
+    for (auto [slot, phi] : phis)
+    {
+        add_phi_operands(slot, phi);
     }
 }
 
-string ir_builder::get_bin_inst(arithmetic_operator oper, bool is_signed)
+// appends further instructions to a block placed earlier, for passes over a finished function
+void ir_builder::insert_into(ir_basic_block* block)
 {
-    switch (oper)
+    _block = block;
+}
+
+ir_argument* ir_builder::argument(uint32_t index) const
+{
+    return _function->arguments[index];
+}
+
+void ir_builder::define_variable(uint32_t slot, ir_value* value)
+{
+    if (_memory_locals)
+    {
+        store(value, allocate(slot, value->type));
+    }
+    else
     {
-        case arithmetic_operator::Add: return "add";
-        case arithmetic_operator::Sub: return "sub";
-        case arithmetic_operator::Mul: return "mul";
-        case arithmetic_operator::Div: return is_signed ? "sdiv" : "udiv";
+        write_variable(slot, value);
+    }
+}
 
-        default: throw std::runtime_error("unknown oper");
+void ir_builder::write_variable(uint32_t slot, ir_value* value)
+{
+    if (_memory_locals)
+    {
+        store(value, _slots[slot]);
+    }
+    else
+    {
+        _definitions.set(_block, slot, value);
     }
 }
 
-string ir_builder::get_comp_kind(relational_operator oper, bool is_signed)
+ir_value* ir_builder::read_variable(uint32_t slot, ir_type type)
 {
-    switch (oper)
+    if (_memory_locals)
     {
-        case relational_operator::Equal: return "eq";
-        case relational_operator::NotEqual: return "ne";
-        case relational_operator::Greater: return is_signed ? "sgt" : "ugt";
-        case relational_operator::GreaterEqual: return is_signed ? "sge" : "uge";
-        case relational_operator::Less: return is_signed ? "slt" : "ult";
-        case relational_operator::LessEqual: return is_signed ? "sle" : "ule";
+        return load(type, _slots[slot]);
+    }
 
-        default: throw std::runtime_error("unknown oper");
+    return read_variable(slot, type, _block);
+}
+
+// the predecessors of a block are the blocks whose terminator uses it
+ir_value* ir_builder::read_variable(uint32_t slot, ir_type type, ir_basic_block* block)
+{
+    ir_value* defined = _definitions.find(block, slot);
+
+    if (defined != nullptr)
+    {
+        ir_value* current = resolve(defined);
+
+        if (current != defined)
+        {
+            _definitions.set(block, slot, current);
+        }
+
+        return current;
+    }
+
+    ir_value* value = nullptr;
+    auto incomplete = _incomplete_phis.find(block);
+
+    if (incomplete != _incomplete_phis.end())
+    {
+        ir_instruction* phi = new (_storage) ir_instruction(ir_opcode::Phi, type);
+
+        block->prepend(phi);
+        incomplete->second.emplace_back(slot, phi);
+
+        value = phi;
+    }
+    else
+    {
+        ir_basic_block* predecessor = nullptr;
+        uint32_t predecessor_count = 0;
+
+        for (ir_use* use = block->uses; use != nullptr; use = use->next)
+        {
+            if (use->user->is_terminator())
+            {
+                predecessor = use->user->parent;
+                predecessor_count++;
+            }
+        }
+
+        if (predecessor_count == 0)
+        {
+            // only unreachable code reads a variable no path has written
+            value = undefined(type);
+        }
+        else if (predecessor_count == 1)
+        {
+            value = read_variable(slot, type, predecessor);
+        }
+        else
+        {
+            ir_instruction* phi = new (_storage) ir_instruction(ir_opcode::Phi, type);
+
+            block->prepend(phi);
+
+            // the phi is the definition while its operands are looked up, which ends the search around loops
+            _definitions.set(block, slot, phi);
+
+            value = add_phi_operands(slot, phi);
+        }
+    }
+
+    _definitions.set(block, slot, value);
+
+    return value;
+}
+
+ir_value* ir_builder::add_phi_operands(uint32_t slot, ir_instruction* phi)
+{
+    vector<ir_basic_block*> predecessors;
+
+    for (ir_use* use = phi->parent->uses; use != nullptr; use = use->next)
+    {
+        if (use->user->is_terminator())
+        {
+            predecessors.push_back(use->user->parent);
+        }
+    }
+
+    for (ir_basic_block* predecessor : predecessors)
+    {
+        add_incoming(phi, read_variable(slot, phi->type, predecessor), predecessor);
+    }
+
+    return remove_trivial_phi(phi);
+}
+
+// a phi merging a single value besides itself and undefined ones is replaced by that value,
+// which can make the phis using it trivial in turn
+ir_value* ir_builder::remove_trivial_phi(ir_instruction* phi)
+{
+    ir_value* same = nullptr;
+
+    for (uint32_t i = 0; i < phi->operand_count; i += 2)
+    {
+        ir_value* incoming = phi->operand(i);
+
+        if (incoming == same || incoming == phi || incoming->value_kind == ir_value_kind::Undefined)
+        {
+            continue;
+        }
+
+        if (same != nullptr)
+        {
+            return phi;
+        }
+
+        same = incoming;
+    }
+
+    if (same == nullptr)
+    {
+        same = undefined(phi->type);
+    }
+
+    vector<ir_instruction*> users;
+
+    for (ir_use* use = phi->uses; use != nullptr; use = use->next)
+    {
+        if (use->user != phi && use->user->opcode == ir_opcode::Phi)
+        {
+            users.push_back(use->user);
+        }
+    }
+
+    phi->replace_uses(same);
+    phi->parent->remove(phi);
+
+    _replaced[phi] = same;
+
+    for (ir_instruction* user : users)
+    {
+        if (user->parent != nullptr)
+        {
+            remove_trivial_phi(user);
+        }
     }
-}
\ No newline at end of file
+
+    // the users may have replaced same in turn
+    return resolve(same);
+}
+
+// definitions recorded before a phi was removed still name it
+ir_value* ir_builder::resolve(ir_value* value) const
+{
+    while (value->value_kind == ir_value_kind::Instruction && static_cast<ir_instruction*>(value)->parent == nullptr)
+    {
+        value = _replaced.at(value);
+    }
+
+    return value;
+}
+
+// code following a terminator is unreachable and goes into a block of its own
+ir_instruction* ir_builder::append(ir_opcode opcode, ir_type type, uint32_t operand_count, ir_predicate predicate)
+{
+    if (_block->terminated())
+    {
+        place(create_block());
+    }
+
+    ir_instruction* instruction = new (_storage) ir_instruction(opcode, type, predicate);
+
+    reserve(instruction, operand_count);
+    instruction->operand_count = operand_count;
+
+    _block->append(instruction);
+
+    return instruction;
+}
+
+void ir_builder::reserve(ir_instruction* instruction, uint32_t capacity)
+{
+    if (capacity <= instruction->operand_capacity)
+    {
+        return;
+    }
+
+    ir_use* storage = static_cast<ir_use*>(_storage.allocate(sizeof(ir_use) * capacity, alignof(ir_use)));
+
+    instruction->move_operands(storage, capacity);
+}
+
+// i32 constants are kept sign extended, i8 constants zero extended as bytes are unsigned
+// and i1 constants as 0 or 1, whatever width the value was computed in
+ir_value* ir_builder::constant(ir_type type, long long value)
+{
+    if (type == ir_type::I32)
+    {
+        value = static_cast<int32_t>(static_cast<uint32_t>(value));
+    }
+    else if (type == ir_type::I8)
+    {
+        value = value & 0xff;
+    }
+    else if (type == ir_type::I1)
+    {
+        value = value & 1;
+    }
+
+    return new (_storage) ir_constant(type, value);
+}
+
+ir_value* ir_builder::undefined(ir_type type)
+{
+    return new (_storage) ir_undefined(type);
+}
+
+// unnamed globals are numbered, named ones keep their name
+ir_global* ir_builder::global(string_view name, string_view content)
+{
+    uint32_t number = name.empty() ? static_cast<uint32_t>(_context.next_global()) : 0;
+    ir_global* global = new (_storage) ir_global(number, name, content);
+
+    _module.add_global(global);
+
+    return global;
+}
+
+ir_value* ir_builder::element_pointer(ir_global* global)
+{
+    ir_instruction* pointer = append(ir_opcode::ElementPointer, ir_type::I8Ptr, 1);
+
+    pointer->set_operand(0, global);
+
+    return pointer;
+}
+
+ir_value* ir_builder::string_constant(string_view content)
+{
+    return element_pointer(global(string_view(), content));
+}
+
+// arithmetic wraps around, division by zero and the overflowing INT_MIN / -1 are left to run time
+static bool fold_binary(ir_opcode opcode, int32_t left, int32_t right, uint32_t& result)
+{
+    uint32_t unsigned_left = static_cast<uint32_t>(left);
+    uint32_t unsigned_right = static_cast<uint32_t>(right);
+
+    switch (opcode)
+    {
+        case ir_opcode::Add: result = unsigned_left + unsigned_right; return true;
+        case ir_opcode::Sub: result = unsigned_left - unsigned_right; return true;
+        case ir_opcode::Mul: result = unsigned_left * unsigned_right; return true;
+        case ir_opcode::And: result = unsigned_left & unsigned_right; return true;
+
+        case ir_opcode::SDiv:
+            if (right == 0 || (left == INT32_MIN && right == -1))
+            {
+                return false;
+            }
+
+            result = static_cast<uint32_t>(left / right);
+            return true;
+
+        case ir_opcode::UDiv:
+            if (right == 0)
+            {
+                return false;
+            }
+
+            result = unsigned_left / unsigned_right;
+            return true;
+
+        default: return false;
+    }
+}
+
+static bool fold_compare(ir_predicate predicate, int32_t left, int32_t right)
+{
+    uint32_t unsigned_left = static_cast<uint32_t>(left);
+    uint32_t unsigned_right = static_cast<uint32_t>(right);
+
+    switch (predicate)
+    {
+        case ir_predicate::Eq: return left == right;
+        case ir_predicate::Ne: return left != right;
+        case ir_predicate::Sgt: return left > right;
+        case ir_predicate::Sge: return left >= right;
+        case ir_predicate::Slt: return left < right;
+        case ir_predicate::Sle: return left <= right;
+        case ir_predicate::Ugt: return unsigned_left > unsigned_right;
+        case ir_predicate::Uge: return unsigned_left >= unsigned_right;
+        case ir_predicate::Ult: return unsigned_left < unsigned_right;
+        case ir_predicate::Ule: return unsigned_left <= unsigned_right;
+
+        default: throw std::runtime_error("no predicate");
+    }
+}
+
+static bool is_constant(const ir_value* value)
+{
+    return value->value_kind == ir_value_kind::Constant;
+}
+
+static int32_t constant_value(const ir_value* value)
+{
+    return static_cast<int32_t>(static_cast<const ir_constant*>(value)->value);
+}
+
+// instructions on constants are folded as they are built, so no instruction ever has only constant operands
+ir_value* ir_builder::binary(ir_opcode opcode, ir_value* left, ir_value* right)
+{
+    uint32_t folded = 0;
+
+    if (left->type != ir_type::I1 && is_constant(left) && is_constant(right) && fold_binary(opcode, constant_value(left), constant_value(right), folded))
+    {
+        return constant(left->type, folded);
+    }
+
+    ir_instruction* instruction = append(opcode, left->type, 2);
+
+    instruction->set_operand(0, left);
+    instruction->set_operand(1, right);
+
+    return instruction;
+}
+
+// a byte widens with zext and narrows with trunc, narrowing a widened byte gives back the byte
+ir_value* ir_builder::convert(ir_value* value, ir_type type)
+{
+    if (value->type == type)
+    {
+        return value;
+    }
+
+    if (is_constant(value))
+    {
+        return constant(type, static_cast<const ir_constant*>(value)->value);
+    }
+
+    if (value->value_kind == ir_value_kind::Instruction && static_cast<ir_instruction*>(value)->opcode == ir_opcode::ZExt &&
+        static_cast<ir_instruction*>(value)->operand(0)->type == type)
+    {
+        return static_cast<ir_instruction*>(value)->operand(0);
+    }
+
+    ir_instruction* instruction = append(type == ir_type::I8 ? ir_opcode::Trunc : ir_opcode::ZExt, type, 1);
+
+    instruction->set_operand(0, value);
+
+    return instruction;
+}
+
+ir_value* ir_builder::compare(ir_predicate predicate, ir_value* left, ir_value* right)
+{
+    if (is_constant(left) && is_constant(right))
+    {
+        return constant(ir_type::I1, fold_compare(predicate, constant_value(left), constant_value(right)));
+    }
+
+    ir_instruction* instruction = append(ir_opcode::ICmp, ir_type::I1, 2, predicate);
+
+    instruction->set_operand(0, left);
+    instruction->set_operand(1, right);
+
+    return instruction;
+}
+
+ir_value* ir_builder::select(ir_value* condition, ir_value* true_value, ir_value* false_value)
+{
+    if (is_constant(condition))
+    {
+        return constant_value(condition) != 0 ? true_value : false_value;
+    }
+
+    ir_instruction* instruction = append(ir_opcode::Select, true_value->type, 3);
+
+    instruction->set_operand(0, condition);
+    instruction->set_operand(1, true_value);
+    instruction->set_operand(2, false_value);
+
+    return instruction;
+}
+
+ir_instruction* ir_builder::phi(ir_type type)
+{
+    return append(ir_opcode::Phi, type, 0);
+}
+
+// incoming pairs are stored as value, block operands
+void ir_builder::add_incoming(ir_instruction* phi, ir_value* value, ir_basic_block* block)
+{
+    uint32_t index = phi->operand_count;
+
+    if (index + 2 > phi->operand_capacity)
+    {
+        reserve(phi, phi->operand_capacity == 0 ? 4 : phi->operand_capacity * 2);
+    }
+
+    phi->operand_count += 2;
+    phi->set_operand(index, value);
+    phi->set_operand(index + 1, block);
+}
+
+// the last pair takes the place of the removed one
+void ir_builder::remove_incoming(ir_instruction* phi, uint32_t index)
+{
+    uint32_t last = phi->operand_count - 2;
+
+    if (index != last)
+    {
+        phi->set_operand(index, phi->operand(last));
+        phi->set_operand(index + 1, phi->operand(last + 1));
+    }
+
+    phi->set_operand(last, nullptr);
+    phi->set_operand(last + 1, nullptr);
+    phi->operand_count -= 2;
+}
+
+// slots are allocated together at the top of the entry block wherever the local is declared,
+// so a declaration in a loop does not grow the stack per iteration and mem2reg can promote every slot
+ir_value* ir_builder::allocate(uint32_t slot, ir_type type)
+{
+    ir_instruction* instruction = new (_storage) ir_instruction(ir_opcode::Alloca, ir_type::Pointer);
+
+    instruction->allocated_type = type;
+
+    if (_last_allocation == nullptr)
+    {
+        _function->first_block->prepend(instruction);
+    }
+    else
+    {
+        _function->first_block->insert_after(_last_allocation, instruction);
+    }
+
+    _last_allocation = instruction;
+
+    if (slot >= _slots.size())
+    {
+        _slots.resize(slot + 1, nullptr);
+    }
+
+    _slots[slot] = instruction;
+
+    return instruction;
+}
+
+ir_value* ir_builder::load(ir_type type, ir_value* pointer)
+{
+    ir_instruction* instruction = append(ir_opcode::Load, type, 1);
+
+    instruction->set_operand(0, pointer);
+
+    return instruction;
+}
+
+void ir_builder::store(ir_value* value, ir_value* pointer)
+{
+    ir_instruction* instruction = append(ir_opcode::Store, ir_type::Void, 2);
+
+    instruction->set_operand(0, value);
+    instruction->set_operand(1, pointer);
+}
+
+ir_instruction* ir_builder::call(ir_function* callee, uint32_t argument_count)
+{
+    ir_instruction* instruction = append(ir_opcode::Call, callee->return_type, argument_count);
+
+    instruction->callee = callee;
+
+    return instruction;
+}
+
+// a jump out of a terminated block could never be taken, leaving it out keeps the target's predecessors exact
+void ir_builder::branch(ir_basic_block* target)
+{
+    if (terminated())
+    {
+        return;
+    }
+
+    ir_instruction* instruction = append(ir_opcode::Br, ir_type::Void, 1);
+
+    instruction->set_operand(0, target);
+}
+
+void ir_builder::branch(ir_value* condition, ir_basic_block* true_target, ir_basic_block* false_target)
+{
+    ir_instruction* instruction = append(ir_opcode::CondBr, ir_type::Void, 3);
+
+    instruction->set_operand(0, condition);
+    instruction->set_operand(1, true_target);
+    instruction->set_operand(2, false_target);
+}
+
+void ir_builder::add_patch(patch_list& list, ir_use* target)
+{
+    if (list.empty())
+    {
+        list.head = target;
+    }
+    else
+    {
+        list.tail->next = target;
+    }
+
+    list.tail = target;
+}
+
+void ir_builder::branch(patch_list& list)
+{
+    if (terminated())
+    {
+        return;
+    }
+
+    ir_instruction* instruction = append(ir_opcode::Br, ir_type::Void, 1);
+
+    add_patch(list, &instruction->operands[0]);
+}
+
+// a constant condition only ever takes one of the edges
+void ir_builder::branch(ir_value* condition, patch_list& true_list, patch_list& false_list)
+{
+    if (is_constant(condition))
+    {
+        branch(constant_value(condition) != 0 ? true_list : false_list);
+        return;
+    }
+
+    ir_instruction* instruction = append(ir_opcode::CondBr, ir_type::Void, 3);
+
+    instruction->set_operand(0, condition);
+
+    add_patch(true_list, &instruction->operands[1]);
+    add_patch(false_list, &instruction->operands[2]);
+}
+
+void ir_builder::ret()
+{
+    append(ir_opcode::Ret, ir_type::Void, 0);
+}
+
+void ir_builder::ret(ir_value* value)
+{
+    ir_instruction* instruction = append(ir_opcode::Ret, ir_type::Void, 1);
+
+    instruction->set_operand(0, value);
+}
+
+void ir_builder::unreachable()
+{
+    append(ir_opcode::Unreachable, ir_type::Void, 0);
+}
+
+bool ir_builder::terminated() const
+{
+    return _block->terminated();
+}
+
+void ir_builder::merge(patch_list& into, patch_list& from)
+{
+    if (from.empty())
+    {
+        return;
+    }
+
+    if (into.empty())
+    {
+        into.head = from.head;
+    }
+    else
+    {
+        into.tail->next = from.head;
+    }
+
+    into.tail = from.tail;
+    from = patch_list();
+}
+
+void ir_builder::backpatch(patch_list& list, ir_basic_block* target)
+{
+    for (ir_use* use = list.head; use != nullptr; )
+    {
+        ir_use* next = use->next;
+
+        use->user->set_operand(static_cast<uint32_t>(use - use->user->operands), target);
+
+        use = next;
+    }
+
+    list = patch_list();
+}
+
+// continues emitting where the jumps in the list lead, a single jump just ending the current block is dropped instead
+void ir_builder::land(patch_list& list)
+{
+    if (list.head != nullptr && list.head == list.tail && list.head->user == _block->last && _block->last->opcode == ir_opcode::Br)
+    {
+        _block->remove(_block->last);
+        list = patch_list();
+
+        return;
+    }
+
+    ir_basic_block* block = create_block();
+
+    backpatch(list, block);
+    place(block);
+}
+
+// turns jumping code into an i1, a side never jumped to makes the value a constant
+ir_value* ir_builder::materialize(patch_list& true_list, patch_list& false_list)
+{
+    if (true_list.empty() || false_list.empty())
+    {
+        bool value = false_list.empty();
+
+        land(value ? true_list : false_list);
+
+        return constant(ir_type::I1, value);
+    }
+
+    ir_basic_block* true_block = create_block();
+    ir_basic_block* false_block = create_block();
+    ir_basic_block* join_block = create_block();
+
+    backpatch(true_list, true_block);
+    place(true_block);
+    branch(join_block);
+
+    backpatch(false_list, false_block);
+    place(false_block);
+    branch(join_block);
+
+    place(join_block);
+
+    ir_instruction* merged = phi(ir_type::I1);
+
+    add_incoming(merged, constant(ir_type::I1, 1), true_block);
+    add_incoming(merged, constant(ir_type::I1, 0), false_block);
+
+    return merged;
+}
+
+// builtins and their globals are only emitted once something calls them,
+// printf and exit are declared last since the builtin bodies are what calls them
+void ir_builder::define_builtin_functions()
+{
+    ir_function* printf = _module.declare_function("printf", ir_type::I32, { ir_type::I8Ptr }, true);
+    ir_function* exit = _module.function("exit");
+    ir_function* error_zero_div = _module.function("error_zero_div");
+
+    if (error_zero_div->referenced)
+    {
+        begin_function(error_zero_div);
+
+        ir_value* format = element_pointer(global(".str_zero_div", "Error division by zero\\0A"));
+        ir_instruction* message = call(printf, 1);
+
+        message->set_operand(0, format);
+
+        ir_instruction* terminate = call(exit, 1);
+
+        terminate->set_operand(0, constant(ir_type::I32, -1));
+
+        unreachable();
+        end_function();
+    }
+
+    for (auto [name, specifier, content] : { std::make_tuple("printi", ".int_specifier", "%d\\0A"), std::make_tuple("print", ".str_specifier", "%s\\0A") })
+    {
+        ir_function* function = _module.function(name);
+
+        if (function->referenced == false)
+        {
+            continue;
+        }
+
+        begin_function(function);
+
+        ir_value* format = element_pointer(global(specifier, content));
+        ir_instruction* print = call(printf, 2);
+
+        print->set_operand(0, format);
+        print->set_operand(1, argument(0));
+
+        ret();
+        end_function();
+    }
+
+    for (ir_function* external : { printf, exit })
+    {
+        if (external->referenced)
+        {
+            _module.add_declaration(external);
+        }
+    }
+}
@@ -3,54 +3,140 @@
 
 #include "../types.hpp"
 #include "../syntax/syntax_operators.hpp"
-#include <vector>
+#include "../memory/arena.hpp"
+#include "ir.hpp"
+#include "ir_format.hpp"
+#include "definition_table.hpp"
 #include <string>
-#include <memory>
-#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class compilation_context;
+
+// chain of branches whose target is not known yet, threaded through their unset target operands
+struct patch_list
+{
+    ir_use* head = nullptr;
+    ir_use* tail = nullptr;
 
+    bool empty() const
+    {
+        return head == nullptr;
+    }
+};
+
+// locals are turned into SSA values while the function is emitted, following Braun et al.,
+// "Simple and Efficient Construction of Static Single Assignment Form".
+// a placed block is sealed, meaning all its predecessors are known, unless it is placed unsealed and sealed later
 class ir_builder
 {
+    private:
+
+    compilation_context& _context;
+    arena& _storage;
+    ir_module& _module;
+    ir_function* _function;
+    ir_basic_block* _block;
+    bool _memory_locals;
+    ir_instruction* _last_allocation;
+    // the globals before it belong to functions already finished
+    std::size_t _first_global;
+    std::vector<ir_value*> _slots;
+    definition_table _definitions;
+    std::unordered_map<const ir_basic_block*, std::vector<std::pair<uint32_t, ir_instruction*>>> _incomplete_phis;
+    std::unordered_map<const ir_value*, ir_value*> _replaced;
+
+    ir_builder(compilation_context& context, arena& storage, ir_module& module);
+
+    friend class compilation_context;
+
+    ir_instruction* append(ir_opcode opcode, ir_type type, uint32_t operand_count, ir_predicate predicate = ir_predicate::None);
+    void reserve(ir_instruction* instruction, uint32_t capacity);
+    void add_patch(patch_list& list, ir_use* target);
+
+    ir_value* read_variable(uint32_t slot, ir_type type, ir_basic_block* block);
+    ir_value* add_phi_operands(uint32_t slot, ir_instruction* phi);
+    ir_value* remove_trivial_phi(ir_instruction* phi);
+    ir_value* resolve(ir_value* value) const;
+
     public:
 
-    static std::string fresh_register();
-    static std::string fresh_label();
-    static std::string fresh_global();
+    ir_builder(const ir_builder& other) = delete;
+    ir_builder& operator=(const ir_builder& other) = delete;
 
-    static std::string get_ir_type(type_kind type);
-    static std::string get_bin_inst(arithmetic_operator oper, bool is_signed);
-    static std::string get_comp_kind(relational_operator oper, bool is_signed);
+    static ir_builder& instance();
 
-    template<typename ... Args>
-    static std::string format_string(const std::string& format, Args ... args)
-    {
-        int size_s = std::snprintf(nullptr, 0, format.c_str(), as_ctype(args) ...) + 1;
+    static ir_type get_ir_type(type_kind type);
+    static ir_opcode get_bin_inst(arithmetic_operator oper, bool is_signed);
+    static ir_predicate get_comp_kind(relational_operator oper, bool is_signed);
 
-        if (size_s <= 0)
-        {
-            throw std::runtime_error("Error during formatting.");
-        }
+    ir_function* declare_function(std::string_view name, type_kind return_type, const std::vector<type_kind>& parameter_types);
 
-        auto size = static_cast<size_t>(size_s);
+    void begin_function(ir_function* function);
+    void end_function();
 
-        std::unique_ptr<char[]> buffer(new char[size]);
+    ir_basic_block* create_block();
+    void place(ir_basic_block* block);
+    void place_unsealed(ir_basic_block* block);
+    void seal(ir_basic_block* block);
+    void insert_into(ir_basic_block* block);
 
-        std::snprintf(buffer.get(), size, format.c_str(), as_ctype(args) ...);
+    ir_argument* argument(uint32_t index) const;
 
-        return std::string(buffer.get(), buffer.get() + size - 1);
-    }
+    void define_variable(uint32_t slot, ir_value* value);
+    void write_variable(uint32_t slot, ir_value* value);
+    ir_value* read_variable(uint32_t slot, ir_type type);
 
-    private:
+    ir_value* constant(ir_type type, long long value);
+    ir_value* undefined(ir_type type);
+    ir_global* global(std::string_view name, std::string_view content);
+    ir_value* element_pointer(ir_global* global);
+    ir_value* string_constant(std::string_view content);
 
-    template<class T>
-    static T const& as_ctype(T const& arg)
-    {
-        return arg;
-    }
+    ir_value* binary(ir_opcode opcode, ir_value* left, ir_value* right);
+    ir_value* convert(ir_value* value, ir_type type);
+    ir_value* compare(ir_predicate predicate, ir_value* left, ir_value* right);
+    ir_value* select(ir_value* condition, ir_value* true_value, ir_value* false_value);
+
+    ir_instruction* phi(ir_type type);
+    void add_incoming(ir_instruction* phi, ir_value* value, ir_basic_block* block);
+    void remove_incoming(ir_instruction* phi, uint32_t index);
+
+    ir_value* allocate(uint32_t slot, ir_type type);
+    ir_value* load(ir_type type, ir_value* pointer);
+    void store(ir_value* value, ir_value* pointer);
 
-    static const char* as_ctype(std::string const& arg)
+    ir_instruction* call(ir_function* callee, uint32_t argument_count);
+
+    void branch(ir_basic_block* target);
+    void branch(ir_value* condition, ir_basic_block* true_target, ir_basic_block* false_target);
+    void branch(patch_list& list);
+    void branch(ir_value* condition, patch_list& true_list, patch_list& false_list);
+    void ret();
+    void ret(ir_value* value);
+    void unreachable();
+
+    // code emitted now cannot be reached, the current block already ends in a terminator
+    bool terminated() const;
+
+    void merge(patch_list& into, patch_list& from);
+    void backpatch(patch_list& list, ir_basic_block* target);
+    void land(patch_list& list);
+    ir_value* materialize(patch_list& true_list, patch_list& false_list);
+
+    void define_builtin_functions();
+
+    template<typename Text, typename ... Args>
+    static std::string format_string(ir_format::format<Text> format, const Args& ... args)
     {
-        return arg.c_str();
+        std::string result;
+
+        ir_format::write(result, format, args ...);
+
+        return result;
     }
 };
 
-#endif
\ No newline at end of file
+#endif
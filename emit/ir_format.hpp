@@ -0,0 +1,140 @@
+#ifndef _IR_FORMAT_HPP_
+#define _IR_FORMAT_HPP_
+
+#include <string_view>
+#include <type_traits>
+#include <charconv>
+#include <cstddef>
+
+// wraps a string literal so its text is available as a constant expression inside the formatting templates
+#define IR_FORMAT(text) ir_format::make_format([] { return std::string_view(text); })
+
+namespace ir_format
+{
+    // %s takes anything convertible to std::string_view, %d and %llu take any integer, %% is a literal percent sign
+    enum class spec_kind
+    {
+        String,
+        Integer
+    };
+
+    template<typename Text> struct format
+    {
+        Text text;
+    };
+
+    template<typename Text> constexpr format<Text> make_format(Text text)
+    {
+        return { text };
+    }
+
+    // the literal with every %% collapsed, and the offset in it at which each argument is written
+    template<std::size_t Size> struct parsed_format
+    {
+        char text[Size + 1];
+        std::size_t text_size;
+        std::size_t spec_offsets[Size + 1];
+        spec_kind specs[Size + 1];
+        std::size_t spec_count;
+        bool valid;
+    };
+
+    template<std::size_t Size> constexpr parsed_format<Size> parse(std::string_view format)
+    {
+        parsed_format<Size> result{};
+
+        result.valid = true;
+
+        for (std::size_t i = 0; i < format.size(); i++)
+        {
+            if (format[i] != '%')
+            {
+                result.text[result.text_size++] = format[i];
+                continue;
+            }
+
+            std::string_view spec = format.substr(i + 1);
+
+            if (spec.substr(0, 1) == "%")
+            {
+                result.text[result.text_size++] = '%';
+                i += 1;
+            }
+            else if (spec.substr(0, 1) == "s" || spec.substr(0, 1) == "d" || spec.substr(0, 3) == "llu")
+            {
+                result.spec_offsets[result.spec_count] = result.text_size;
+                result.specs[result.spec_count++] = spec[0] == 's' ? spec_kind::String : spec_kind::Integer;
+                i += spec[0] == 'l' ? 3 : 1;
+            }
+            else
+            {
+                result.valid = false;
+            }
+        }
+
+        return result;
+    }
+
+    template<typename T> constexpr bool matches(spec_kind kind)
+    {
+        if (kind == spec_kind::Integer)
+        {
+            return std::is_integral<T>::value;
+        }
+
+        return std::is_convertible<const T&, std::string_view>::value;
+    }
+
+    template<typename ... Args, std::size_t Size> constexpr bool accepts(const parsed_format<Size>& format)
+    {
+        std::size_t index = 0;
+        bool result = true;
+
+        ((result = result && matches<Args>(format.specs[index++])), ...);
+
+        return result;
+    }
+
+    template<typename Sink> void write_argument(Sink& sink, std::string_view value)
+    {
+        sink.append(value);
+    }
+
+    template<typename Sink, typename T> std::enable_if_t<std::is_integral<T>::value> write_argument(Sink& sink, T value)
+    {
+        using wide = std::conditional_t<std::is_signed<T>::value, long long, unsigned long long>;
+
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), static_cast<wide>(value));
+
+        sink.append(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+    }
+
+    // appends the formatted text to any sink with an append(std::string_view) member
+    template<typename Sink, typename Text, typename ... Args> void write(Sink& sink, format<Text> format, const Args& ... args)
+    {
+        constexpr std::string_view text = format.text();
+        static constexpr parsed_format<text.size()> parsed = parse<text.size()>(text);
+
+        static_assert(parsed.valid, "unsupported format specifier, expected %s, %d, %llu or %%");
+        static_assert(parsed.spec_count == sizeof...(Args), "format string expects a different number of arguments");
+        static_assert(accepts<Args ...>(parsed), "format argument does not match its specifier");
+
+        std::size_t begin = 0;
+        std::size_t index = 0;
+
+        auto write_next = [&](const auto& arg)
+        {
+            sink.append(std::string_view(parsed.text + begin, parsed.spec_offsets[index] - begin));
+            write_argument(sink, arg);
+
+            begin = parsed.spec_offsets[index++];
+        };
+
+        (write_next(args), ...);
+
+        sink.append(std::string_view(parsed.text + begin, parsed.text_size - begin));
+    }
+}
+
+#endif
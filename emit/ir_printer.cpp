@@ -0,0 +1,365 @@
+#include "ir_printer.hpp"
+#include <stdexcept>
+
+using std::string_view;
+
+ir_printer::ir_printer(code_buffer& code, bool compact): _code(code), _compact(compact)
+{
+}
+
+string_view ir_printer::type_name(ir_type type)
+{
+    switch (type)
+    {
+        case ir_type::Void: return "void";
+        case ir_type::I1: return "i1";
+        case ir_type::I8: return "i8";
+        case ir_type::I32: return "i32";
+        case ir_type::I8Ptr: return "i8*";
+        case ir_type::Label: return "label";
+
+        default: throw std::runtime_error("type has no name");
+    }
+}
+
+string_view ir_printer::opcode_name(ir_opcode opcode)
+{
+    switch (opcode)
+    {
+        case ir_opcode::Add: return "add";
+        case ir_opcode::Sub: return "sub";
+        case ir_opcode::Mul: return "mul";
+        case ir_opcode::SDiv: return "sdiv";
+        case ir_opcode::UDiv: return "udiv";
+        case ir_opcode::And: return "and";
+        case ir_opcode::ZExt: return "zext";
+        case ir_opcode::Trunc: return "trunc";
+
+        default: throw std::runtime_error("not a binary or cast opcode");
+    }
+}
+
+string_view ir_printer::predicate_name(ir_predicate predicate)
+{
+    switch (predicate)
+    {
+        case ir_predicate::Eq: return "eq";
+        case ir_predicate::Ne: return "ne";
+        case ir_predicate::Sgt: return "sgt";
+        case ir_predicate::Sge: return "sge";
+        case ir_predicate::Slt: return "slt";
+        case ir_predicate::Sle: return "sle";
+        case ir_predicate::Ugt: return "ugt";
+        case ir_predicate::Uge: return "uge";
+        case ir_predicate::Ult: return "ult";
+        case ir_predicate::Ule: return "ule";
+
+        default: throw std::runtime_error("no predicate");
+    }
+}
+
+void ir_printer::print(const ir_module& module)
+{
+    for (const ir_global* global : module.globals())
+    {
+        print_global(global);
+    }
+
+    for (const ir_function* function : module.declarations())
+    {
+        print_declaration(function);
+    }
+
+    for (ir_function* function : module.definitions())
+    {
+        print_function(function);
+    }
+}
+
+void ir_printer::print_declaration(const ir_function* function)
+{
+    _code.begin_line();
+    _code.write(IR_FORMAT("declare %s @%s("), type_name(function->return_type), function->name);
+
+    for (size_t i = 0; i < function->parameter_types.size(); i++)
+    {
+        _code.write(IR_FORMAT("%s%s"), i == 0 ? "" : ", ", type_name(function->parameter_types[i]));
+    }
+
+    _code.write(function->variadic ? ", ...)" : ")");
+    _code.end_line();
+}
+
+void ir_printer::print_global(const ir_global* global)
+{
+    if (global->name.empty() && _compact)
+    {
+        _code.emit_global(IR_FORMAT("@.g%d = constant [%d x i8] c\"%s\\00\""), global->number, global->bytes().size() + 1, global->content);
+    }
+    else if (global->name.empty())
+    {
+        _code.emit_global(IR_FORMAT("@.global_var_%d = constant [%d x i8] c\"%s\\00\""), global->number, global->bytes().size() + 1, global->content);
+    }
+    else
+    {
+        _code.emit_global(IR_FORMAT("@%s = constant [%d x i8] c\"%s\\00\""), global->name, global->bytes().size() + 1, global->content);
+    }
+}
+
+// implicit numbers continue after the arguments and count the entry block, named values start over at zero
+void ir_printer::number_values(ir_function* function, bool compact)
+{
+    uint32_t labels = 0;
+    uint32_t registers = compact ? static_cast<uint32_t>(function->parameter_types.size()) : 0;
+
+    for (ir_basic_block* block = function->first_block; block != nullptr; block = block->next)
+    {
+        block->number = compact ? registers++ : labels++;
+
+        for (ir_instruction* instruction = block->first; instruction != nullptr; instruction = instruction->next)
+        {
+            if (instruction->type != ir_type::Void)
+            {
+                instruction->number = registers++;
+            }
+        }
+    }
+}
+
+void ir_printer::print_function(ir_function* function)
+{
+    number_values(function, _compact);
+
+    _code.begin_line();
+    _code.write(IR_FORMAT("define %s @%s("), type_name(function->return_type), function->name);
+
+    for (size_t i = 0; i < function->parameter_types.size(); i++)
+    {
+        _code.write(IR_FORMAT("%s%s"), i == 0 ? "" : ", ", type_name(function->parameter_types[i]));
+    }
+
+    _code.write(") {");
+    _code.end_line();
+
+    for (const ir_basic_block* block = function->first_block; block != nullptr; block = block->next)
+    {
+        if (_compact == false)
+        {
+            _code.emit(IR_FORMAT("label_%d:"), block->number);
+            _code.increase_indent();
+        }
+        else if (block != function->first_block)
+        {
+            _code.emit(IR_FORMAT("%d:"), block->number);
+        }
+
+        for (const ir_instruction* instruction = block->first; instruction != nullptr; instruction = instruction->next)
+        {
+            print_instruction(instruction);
+        }
+
+        if (_compact == false)
+        {
+            _code.decrease_indent();
+        }
+    }
+
+    _code.emit(_compact ? "}" : "}\n");
+}
+
+void ir_printer::write_value(const ir_value* value)
+{
+    switch (value->value_kind)
+    {
+        case ir_value_kind::Constant: _code.write(IR_FORMAT("%d"), static_cast<const ir_constant*>(value)->value); break;
+        case ir_value_kind::Undefined: _code.write("undef"); break;
+        case ir_value_kind::Argument: _code.write(IR_FORMAT("%%%d"), value->number); break;
+        case ir_value_kind::Global:
+            if (static_cast<const ir_global*>(value)->name.empty() && _compact)
+            {
+                _code.write(IR_FORMAT("@.g%d"), value->number);
+            }
+            else if (static_cast<const ir_global*>(value)->name.empty())
+            {
+                _code.write(IR_FORMAT("@.global_var_%d"), value->number);
+            }
+            else
+            {
+                _code.write(IR_FORMAT("@%s"), static_cast<const ir_global*>(value)->name);
+            }
+            break;
+
+        case ir_value_kind::Block:
+        case ir_value_kind::Instruction:
+            if (_compact)
+            {
+                _code.write(IR_FORMAT("%%%d"), value->number);
+            }
+            else if (value->value_kind == ir_value_kind::Block)
+            {
+                _code.write(IR_FORMAT("%%label_%d"), value->number);
+            }
+            else
+            {
+                _code.write(IR_FORMAT("%%reg_%d"), value->number);
+            }
+            break;
+    }
+}
+
+void ir_printer::write_typed(const ir_value* value)
+{
+    _code.write(IR_FORMAT("%s "), type_name(value->type));
+    write_value(value);
+}
+
+void ir_printer::print_instruction(const ir_instruction* instruction)
+{
+    _code.begin_line();
+
+    if (instruction->type != ir_type::Void)
+    {
+        write_value(instruction);
+        _code.write(" = ");
+    }
+
+    switch (instruction->opcode)
+    {
+        case ir_opcode::Add:
+        case ir_opcode::Sub:
+        case ir_opcode::Mul:
+        case ir_opcode::SDiv:
+        case ir_opcode::UDiv:
+        case ir_opcode::And:
+            _code.write(IR_FORMAT("%s "), opcode_name(instruction->opcode));
+            write_typed(instruction->operand(0));
+            _code.write(", ");
+            write_value(instruction->operand(1));
+            break;
+
+        case ir_opcode::ZExt:
+        case ir_opcode::Trunc:
+            _code.write(IR_FORMAT("%s "), opcode_name(instruction->opcode));
+            write_typed(instruction->operand(0));
+            _code.write(IR_FORMAT(" to %s"), type_name(instruction->type));
+            break;
+
+        case ir_opcode::ICmp:
+            _code.write(IR_FORMAT("icmp %s "), predicate_name(instruction->predicate));
+            write_typed(instruction->operand(0));
+            _code.write(", ");
+            write_value(instruction->operand(1));
+            break;
+
+        case ir_opcode::Select:
+            _code.write("select ");
+            write_typed(instruction->operand(0));
+            _code.write(", ");
+            write_typed(instruction->operand(1));
+            _code.write(", ");
+            write_typed(instruction->operand(2));
+            break;
+
+        case ir_opcode::Phi:
+            _code.write(IR_FORMAT("phi %s "), type_name(instruction->type));
+
+            for (uint32_t i = 0; i < instruction->operand_count; i += 2)
+            {
+                _code.write(i == 0 ? "[ " : ", [ ");
+                write_value(instruction->operand(i));
+                _code.write(", ");
+                write_value(instruction->operand(i + 1));
+                _code.write(" ]");
+            }
+            break;
+
+        case ir_opcode::Alloca:
+            _code.write(IR_FORMAT("alloca %s"), type_name(instruction->allocated_type));
+            break;
+
+        case ir_opcode::Load:
+            _code.write(IR_FORMAT("load %s, %s* "), type_name(instruction->type), type_name(instruction->type));
+            write_value(instruction->operand(0));
+            break;
+
+        case ir_opcode::Store:
+            _code.write("store ");
+            write_typed(instruction->operand(0));
+            _code.write(IR_FORMAT(", %s* "), type_name(instruction->operand(0)->type));
+            write_value(instruction->operand(1));
+            break;
+
+        case ir_opcode::ElementPointer:
+        {
+            size_t size = static_cast<const ir_global*>(instruction->operand(0))->bytes().size() + 1;
+
+            _code.write(IR_FORMAT("getelementptr [%d x i8], [%d x i8]* "), size, size);
+            write_value(instruction->operand(0));
+            _code.write(", i32 0, i32 0");
+            break;
+        }
+
+        case ir_opcode::Call:
+            _code.write(IR_FORMAT("call %s "), type_name(instruction->type));
+
+            // a variadic callee is called through its full function type
+            if (instruction->callee->variadic)
+            {
+                _code.write("(");
+
+                for (ir_type type : instruction->callee->parameter_types)
+                {
+                    _code.write(IR_FORMAT("%s, "), type_name(type));
+                }
+
+                _code.write("...) ");
+            }
+
+            _code.write(IR_FORMAT("@%s("), instruction->callee->name);
+
+            for (uint32_t i = 0; i < instruction->operand_count; i++)
+            {
+                if (i > 0)
+                {
+                    _code.write(", ");
+                }
+
+                write_typed(instruction->operand(i));
+            }
+
+            _code.write(")");
+            break;
+
+        case ir_opcode::Br:
+            _code.write("br ");
+            write_typed(instruction->operand(0));
+            break;
+
+        case ir_opcode::CondBr:
+            _code.write("br ");
+            write_typed(instruction->operand(0));
+            _code.write(", ");
+            write_typed(instruction->operand(1));
+            _code.write(", ");
+            write_typed(instruction->operand(2));
+            break;
+
+        case ir_opcode::Ret:
+            if (instruction->operand_count == 0)
+            {
+                _code.write("ret void");
+            }
+            else
+            {
+                _code.write("ret ");
+                write_typed(instruction->operand(0));
+            }
+            break;
+
+        case ir_opcode::Unreachable:
+            _code.write("unreachable");
+            break;
+    }
+
+    _code.end_line();
+}
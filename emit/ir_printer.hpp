@@ -0,0 +1,42 @@
+#ifndef _IR_PRINTER_HPP_
+#define _IR_PRINTER_HPP_
+
+#include "ir.hpp"
+#include "code_buffer.hpp"
+#include <string_view>
+
+// serializes the module as LLVM assembly into the code buffer.
+// values are numbered per function right before it is printed, compact output uses LLVM's implicit
+// numbering for arguments, blocks and instructions alike and leaves out the indentation
+class ir_printer
+{
+    private:
+
+    code_buffer& _code;
+    const bool _compact;
+
+    static void number_values(ir_function* function, bool compact);
+
+    void print_global(const ir_global* global);
+    void print_declaration(const ir_function* function);
+    void print_function(ir_function* function);
+    void print_instruction(const ir_instruction* instruction);
+
+    void write_value(const ir_value* value);
+    void write_typed(const ir_value* value);
+
+    public:
+
+    explicit ir_printer(code_buffer& code, bool compact = false);
+
+    ir_printer(const ir_printer& other) = delete;
+    ir_printer& operator=(const ir_printer& other) = delete;
+
+    static std::string_view type_name(ir_type type);
+    static std::string_view opcode_name(ir_opcode opcode);
+    static std::string_view predicate_name(ir_predicate predicate);
+
+    void print(const ir_module& module);
+};
+
+#endif
@@ -0,0 +1,235 @@
+#include "output_sink.hpp"
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+static std::runtime_error system_error(const string& what)
+{
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+void output_sink::close()
+{
+}
+
+descriptor_sink::descriptor_sink(int descriptor): _descriptor(descriptor)
+{
+}
+
+void descriptor_sink::write(vector<byte_buffer>& batch)
+{
+    vector<iovec> vectors;
+
+    for (const byte_buffer& buffer : batch)
+    {
+        for (string_view piece : buffer.pieces())
+        {
+            vectors.push_back({ const_cast<char*>(piece.data()), piece.size() });
+        }
+    }
+
+    // a short write leaves the first unfinished vector partially consumed
+    for (size_t first = 0; first < vectors.size(); )
+    {
+        int count = static_cast<int>(std::min<size_t>(vectors.size() - first, IOV_MAX));
+        ssize_t written = ::writev(_descriptor, vectors.data() + first, count);
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            throw system_error("write failed");
+        }
+
+        size_t remaining = static_cast<size_t>(written);
+
+        while (first < vectors.size() && remaining >= vectors[first].iov_len)
+        {
+            remaining -= vectors[first].iov_len;
+            first++;
+        }
+
+        if (remaining > 0)
+        {
+            vectors[first].iov_base = static_cast<char*>(vectors[first].iov_base) + remaining;
+            vectors[first].iov_len -= remaining;
+        }
+    }
+
+    batch.clear();
+}
+
+static int open_output(const string& path)
+{
+    int descriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (descriptor < 0)
+    {
+        throw system_error("cannot open " + path);
+    }
+
+    return descriptor;
+}
+
+file_sink::file_sink(const string& path): descriptor_sink(open_output(path))
+{
+}
+
+file_sink::~file_sink()
+{
+    ::close(_descriptor);
+}
+
+memory_sink::memory_sink(): _contents()
+{
+}
+
+void memory_sink::write(vector<byte_buffer>& batch)
+{
+    for (const byte_buffer& buffer : batch)
+    {
+        for (string_view piece : buffer.pieces())
+        {
+            _contents.append(piece);
+        }
+    }
+
+    batch.clear();
+}
+
+string_view memory_sink::contents() const
+{
+    return _contents;
+}
+
+async_sink::async_sink(std::unique_ptr<output_sink> target):
+    _target(std::move(target)), _mutex(), _ready(), _pending(), _pending_size(0), _failure(), _closing(false), _writer()
+{
+}
+
+async_sink::~async_sink()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+// takes everything pending at once, writes that accumulate meanwhile form the next batch
+void async_sink::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true)
+    {
+        _ready.wait(lock, [this] { return _pending_size >= batch_size || _closing; });
+
+        if (_pending.empty())
+        {
+            return;
+        }
+
+        vector<byte_buffer> batch = std::move(_pending);
+
+        _pending.clear();
+        _pending_size = 0;
+
+        if (_failure != nullptr)
+        {
+            continue;
+        }
+
+        lock.unlock();
+
+        try
+        {
+            _target->write(batch);
+        }
+        catch (...)
+        {
+            lock.lock();
+            _failure = std::current_exception();
+            continue;
+        }
+
+        lock.lock();
+    }
+}
+
+void async_sink::write(vector<byte_buffer>& batch)
+{
+    bool wake = false;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        for (byte_buffer& buffer : batch)
+        {
+            _pending_size += buffer.size();
+            _pending.push_back(std::move(buffer));
+        }
+
+        wake = _pending_size >= batch_size;
+    }
+
+    batch.clear();
+
+    if (wake == false)
+    {
+        return;
+    }
+
+    if (_writer.joinable() == false)
+    {
+        _writer = std::thread(&async_sink::run, this);
+    }
+
+    _ready.notify_one();
+}
+
+// drains the queue and rethrows the first failure of the writer thread
+void async_sink::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _closing = true;
+    }
+
+    if (_writer.joinable())
+    {
+        _ready.notify_one();
+        _writer.join();
+    }
+    else if (_pending.empty() == false)
+    {
+        _target->write(_pending);
+        _pending_size = 0;
+    }
+
+    if (_failure != nullptr)
+    {
+        std::exception_ptr failure = std::exchange(_failure, nullptr);
+
+        std::rethrow_exception(failure);
+    }
+
+    _target->close();
+}
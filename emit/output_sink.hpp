@@ -0,0 +1,98 @@
+#ifndef _OUTPUT_SINK_HPP_
+#define _OUTPUT_SINK_HPP_
+
+#include "byte_buffer.hpp"
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// destination of the emitted code, write takes over the buffers in order and leaves the batch empty
+class output_sink
+{
+    public:
+
+    output_sink() = default;
+    virtual ~output_sink() = default;
+
+    output_sink(const output_sink& other) = delete;
+    output_sink& operator=(const output_sink& other) = delete;
+
+    virtual void write(std::vector<byte_buffer>& batch) = 0;
+
+    // returns once everything written so far has reached the destination
+    virtual void close();
+};
+
+// gathers all chunks of a write into as few writev calls as possible
+class descriptor_sink: public output_sink
+{
+    protected:
+
+    const int _descriptor;
+
+    public:
+
+    explicit descriptor_sink(int descriptor);
+
+    void write(std::vector<byte_buffer>& batch) override;
+};
+
+class file_sink final: public descriptor_sink
+{
+    public:
+
+    explicit file_sink(const std::string& path);
+    ~file_sink() override;
+};
+
+class memory_sink final: public output_sink
+{
+    private:
+
+    std::string _contents;
+
+    public:
+
+    memory_sink();
+
+    void write(std::vector<byte_buffer>& batch) override;
+
+    std::string_view contents() const;
+};
+
+// hands buffers to a writer thread so output overlaps with emitting the next function.
+// a second thread takes malloc off its single threaded fast path, so the writer is only started
+// once a batch worth writing has piled up, smaller outputs are written by close on the calling thread
+class async_sink final: public output_sink
+{
+    private:
+
+    static constexpr std::size_t batch_size = 1 << 20;
+
+    const std::unique_ptr<output_sink> _target;
+
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::vector<byte_buffer> _pending;
+    std::size_t _pending_size;
+    std::exception_ptr _failure;
+    bool _closing;
+    std::thread _writer;
+
+    void run();
+
+    public:
+
+    explicit async_sink(std::unique_ptr<output_sink> target);
+    ~async_sink() override;
+
+    void write(std::vector<byte_buffer>& batch) override;
+    void close() override;
+};
+
+#endif
@@ -0,0 +1,540 @@
+#include "range_analysis.hpp"
+#include "ir_builder.hpp"
+#include <algorithm>
+#include <limits>
+
+using std::max;
+using std::min;
+
+static constexpr int64_t int_min = std::numeric_limits<int32_t>::min();
+static constexpr int64_t int_max = std::numeric_limits<int32_t>::max();
+
+static constexpr value_range nothing = { 1, 0 };
+
+// how many branches above a block are searched for conditions on a value
+static constexpr unsigned guard_depth = 16;
+
+// how often a phi may grow before its growing bound is pushed to the limit of its type
+static constexpr uint32_t widening_threshold = 2;
+
+static constexpr unsigned narrowing_passes = 2;
+
+static bool tracked(ir_type type)
+{
+    return type == ir_type::I1 || type == ir_type::I8 || type == ir_type::I32;
+}
+
+// bytes are unsigned, so an i8 is tracked by its value as a byte
+static value_range full(ir_type type)
+{
+    switch (type)
+    {
+        case ir_type::I1: return { 0, 1 };
+        case ir_type::I8: return { 0, 0xff };
+
+        default: return { int_min, int_max };
+    }
+}
+
+static value_range exact(int64_t value)
+{
+    return { value, value };
+}
+
+static bool same(value_range left, value_range right)
+{
+    return left.low == right.low && left.high == right.high;
+}
+
+static value_range join(value_range left, value_range right)
+{
+    if (left.empty()) return right;
+    if (right.empty()) return left;
+
+    return { min(left.low, right.low), max(left.high, right.high) };
+}
+
+static value_range meet(value_range left, value_range right)
+{
+    value_range result = { max(left.low, right.low), min(left.high, right.high) };
+
+    return result.empty() ? nothing : result;
+}
+
+// arithmetic wraps, a result that leaves the type can be anything
+static value_range wrapped(ir_type type, int64_t low, int64_t high)
+{
+    value_range limit = full(type);
+
+    return low < limit.low || high > limit.high ? limit : value_range{ low, high };
+}
+
+// the divisor has a single sign, so the extremes are at the corners
+static value_range divide_signed(value_range dividend, value_range divisor)
+{
+    if (dividend.low == int_min && divisor.low <= -1 && divisor.high >= -1)
+    {
+        return full(ir_type::I32);
+    }
+
+    int64_t corners[] = { dividend.low / divisor.low, dividend.low / divisor.high, dividend.high / divisor.low, dividend.high / divisor.high };
+
+    return { *std::min_element(std::begin(corners), std::end(corners)), *std::max_element(std::begin(corners), std::end(corners)) };
+}
+
+// a zero divisor never gets past the check, so it contributes nothing
+static value_range divide(value_range dividend, value_range divisor)
+{
+    value_range result = nothing;
+
+    if (divisor.low <= -1)
+    {
+        result = join(result, divide_signed(dividend, { divisor.low, min<int64_t>(divisor.high, -1) }));
+    }
+
+    if (divisor.high >= 1)
+    {
+        result = join(result, divide_signed(dividend, { max<int64_t>(divisor.low, 1), divisor.high }));
+    }
+
+    return result;
+}
+
+static value_range divide_unsigned(value_range dividend, value_range divisor)
+{
+    if (dividend.low < 0 || divisor.low < 0)
+    {
+        return full(ir_type::I32);
+    }
+
+    if (divisor.high < 1)
+    {
+        return nothing;
+    }
+
+    return { dividend.low / divisor.high, dividend.high / max<int64_t>(divisor.low, 1) };
+}
+
+static ir_predicate swapped(ir_predicate predicate)
+{
+    switch (predicate)
+    {
+        case ir_predicate::Sgt: return ir_predicate::Slt;
+        case ir_predicate::Sge: return ir_predicate::Sle;
+        case ir_predicate::Slt: return ir_predicate::Sgt;
+        case ir_predicate::Sle: return ir_predicate::Sge;
+        case ir_predicate::Ugt: return ir_predicate::Ult;
+        case ir_predicate::Uge: return ir_predicate::Ule;
+        case ir_predicate::Ult: return ir_predicate::Ugt;
+        case ir_predicate::Ule: return ir_predicate::Uge;
+
+        default: return predicate;
+    }
+}
+
+static ir_predicate negated(ir_predicate predicate)
+{
+    switch (predicate)
+    {
+        case ir_predicate::Eq: return ir_predicate::Ne;
+        case ir_predicate::Ne: return ir_predicate::Eq;
+        case ir_predicate::Sgt: return ir_predicate::Sle;
+        case ir_predicate::Sge: return ir_predicate::Slt;
+        case ir_predicate::Slt: return ir_predicate::Sge;
+        case ir_predicate::Sle: return ir_predicate::Sgt;
+        case ir_predicate::Ugt: return ir_predicate::Ule;
+        case ir_predicate::Uge: return ir_predicate::Ult;
+        case ir_predicate::Ult: return ir_predicate::Uge;
+        case ir_predicate::Ule: return ir_predicate::Ugt;
+
+        default: return predicate;
+    }
+}
+
+// an unsigned compare agrees with the signed one on two non negative operands, otherwise nothing is learned from it
+static bool as_signed(ir_predicate& predicate, value_range left, value_range right)
+{
+    switch (predicate)
+    {
+        case ir_predicate::Ugt: predicate = ir_predicate::Sgt; break;
+        case ir_predicate::Uge: predicate = ir_predicate::Sge; break;
+        case ir_predicate::Ult: predicate = ir_predicate::Slt; break;
+        case ir_predicate::Ule: predicate = ir_predicate::Sle; break;
+
+        default: return true;
+    }
+
+    return left.low >= 0 && right.low >= 0;
+}
+
+// 1 or 0 when the compare has the same outcome for all values in the ranges, -1 otherwise
+static int decide(ir_predicate predicate, value_range left, value_range right)
+{
+    if (as_signed(predicate, left, right) == false)
+    {
+        return -1;
+    }
+
+    switch (predicate)
+    {
+        case ir_predicate::Eq:
+            if (left.high < right.low || right.high < left.low) return 0;
+            if (left.low == left.high && right.low == right.high) return 1;
+            return -1;
+
+        case ir_predicate::Ne:
+            if (left.high < right.low || right.high < left.low) return 1;
+            if (left.low == left.high && right.low == right.high) return 0;
+            return -1;
+
+        case ir_predicate::Slt:
+            if (left.high < right.low) return 1;
+            if (left.low >= right.high) return 0;
+            return -1;
+
+        case ir_predicate::Sle:
+            if (left.high <= right.low) return 1;
+            if (left.low > right.high) return 0;
+            return -1;
+
+        case ir_predicate::Sgt: return decide(ir_predicate::Slt, right, left);
+        case ir_predicate::Sge: return decide(ir_predicate::Sle, right, left);
+
+        default: return -1;
+    }
+}
+
+// narrows the range of a value known to satisfy value <predicate> other
+static value_range constrain(value_range value, ir_predicate predicate, value_range other)
+{
+    if (value.empty() || other.empty() || as_signed(predicate, value, other) == false)
+    {
+        return value;
+    }
+
+    switch (predicate)
+    {
+        case ir_predicate::Eq:
+            return meet(value, other);
+
+        case ir_predicate::Ne:
+            if (other.low == other.high)
+            {
+                if (value.low == other.low) value.low++;
+                if (value.high == other.low) value.high--;
+            }
+
+            return value.empty() ? nothing : value;
+
+        case ir_predicate::Slt: return meet(value, { int_min, other.high - 1 });
+        case ir_predicate::Sle: return meet(value, { int_min, other.high });
+        case ir_predicate::Sgt: return meet(value, { other.low + 1, int_max });
+        case ir_predicate::Sge: return meet(value, { other.low, int_max });
+
+        default: return value;
+    }
+}
+
+range_analysis::range_analysis(ir_builder& builder, ir_function* function): _builder(builder), _function(function), _ranges(), _updates(), _guards()
+{
+}
+
+value_range range_analysis::range(const ir_value* value) const
+{
+    switch (value->value_kind)
+    {
+        case ir_value_kind::Constant: return exact(static_cast<const ir_constant*>(value)->value);
+        case ir_value_kind::Undefined: return nothing;
+
+        case ir_value_kind::Instruction:
+            if (value->number != 0)
+            {
+                return _ranges[value->number - 1];
+            }
+
+            return full(value->type);
+
+        default: return full(value->type);
+    }
+}
+
+// conditions above the block that defines the value cannot mention it, so the search ends there
+value_range range_analysis::range_at(const ir_value* value, const ir_basic_block* block) const
+{
+    value_range result = range(value);
+
+    if (value->value_kind == ir_value_kind::Constant)
+    {
+        return result;
+    }
+
+    const ir_basic_block* definition = value->value_kind == ir_value_kind::Instruction ? static_cast<const ir_instruction*>(value)->parent : nullptr;
+
+    for (unsigned depth = 0; depth < guard_depth && block != definition; depth++)
+    {
+        const guard& entry = _guards[block->number];
+
+        if (entry.predecessor == nullptr)
+        {
+            break;
+        }
+
+        if (entry.condition != nullptr)
+        {
+            ir_predicate predicate = entry.condition->predicate;
+            const ir_value* other = nullptr;
+
+            if (entry.condition->operand(0) == value)
+            {
+                other = entry.condition->operand(1);
+            }
+            else if (entry.condition->operand(1) == value)
+            {
+                other = entry.condition->operand(0);
+                predicate = swapped(predicate);
+            }
+
+            if (other != nullptr)
+            {
+                result = constrain(result, entry.taken ? predicate : negated(predicate), range(other));
+            }
+        }
+
+        block = entry.predecessor;
+    }
+
+    return result;
+}
+
+value_range range_analysis::evaluate(const ir_instruction* instruction) const
+{
+    const ir_basic_block* block = instruction->parent;
+
+    if (instruction->opcode == ir_opcode::Phi)
+    {
+        value_range result = nothing;
+
+        for (uint32_t i = 0; i < instruction->operand_count; i += 2)
+        {
+            result = join(result, range_at(instruction->operand(i), static_cast<const ir_basic_block*>(instruction->operand(i + 1))));
+        }
+
+        return result;
+    }
+
+    // a byte widens unchanged, an int narrows unchanged only when it fits in a byte
+    if (instruction->opcode == ir_opcode::ZExt || instruction->opcode == ir_opcode::Trunc)
+    {
+        value_range operand = range_at(instruction->operand(0), block);
+
+        return instruction->opcode == ir_opcode::ZExt ? operand : wrapped(ir_type::I8, operand.low, operand.high);
+    }
+
+    switch (instruction->opcode)
+    {
+        case ir_opcode::Add:
+        case ir_opcode::Sub:
+        case ir_opcode::Mul:
+        case ir_opcode::SDiv:
+        case ir_opcode::UDiv:
+        case ir_opcode::ICmp:
+        case ir_opcode::Select:
+            break;
+
+        default: return full(instruction->type);
+    }
+
+    value_range left = range_at(instruction->operand(0), block);
+    value_range right = range_at(instruction->operand(1), block);
+
+    if (left.empty() || right.empty())
+    {
+        return nothing;
+    }
+
+    switch (instruction->opcode)
+    {
+        case ir_opcode::Add: return wrapped(instruction->type, left.low + right.low, left.high + right.high);
+        case ir_opcode::Sub: return wrapped(instruction->type, left.low - right.high, left.high - right.low);
+
+        case ir_opcode::Mul:
+        {
+            int64_t corners[] = { left.low * right.low, left.low * right.high, left.high * right.low, left.high * right.high };
+
+            return wrapped(instruction->type, *std::min_element(std::begin(corners), std::end(corners)), *std::max_element(std::begin(corners), std::end(corners)));
+        }
+
+        case ir_opcode::SDiv: return divide(left, right);
+        case ir_opcode::UDiv: return divide_unsigned(left, right);
+
+        case ir_opcode::ICmp:
+        {
+            int outcome = decide(instruction->predicate, left, right);
+
+            return outcome < 0 ? full(ir_type::I1) : exact(outcome);
+        }
+
+        // the condition is the first operand, the choices follow
+        default:
+        {
+            value_range choice = range_at(instruction->operand(2), block);
+
+            if (left.low == left.high)
+            {
+                return left.low != 0 ? right : choice;
+            }
+
+            return join(right, choice);
+        }
+    }
+}
+
+// tracked values index the ranges by their number, blocks index the guards by theirs
+void range_analysis::number_values()
+{
+    uint32_t blocks = 0;
+    uint32_t values = 0;
+
+    for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+    {
+        block->number = blocks++;
+
+        for (ir_instruction* instruction = block->first; instruction != nullptr; instruction = instruction->next)
+        {
+            instruction->number = tracked(instruction->type) ? ++values : 0;
+        }
+    }
+
+    _ranges.assign(values, nothing);
+    _updates.assign(values, 0);
+    _guards.assign(blocks, guard{ nullptr, nullptr, false });
+
+    for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+    {
+        ir_instruction* branch = nullptr;
+        uint32_t predecessor_count = 0;
+
+        for (ir_use* use = block->uses; use != nullptr; use = use->next)
+        {
+            if (use->user->is_terminator())
+            {
+                branch = use->user;
+                predecessor_count++;
+            }
+        }
+
+        if (predecessor_count != 1 || block == _function->first_block)
+        {
+            continue;
+        }
+
+        guard& entry = _guards[block->number];
+
+        entry.predecessor = branch->parent;
+
+        if (branch->opcode == ir_opcode::CondBr)
+        {
+            ir_value* condition = branch->operand(0);
+
+            if (condition->value_kind == ir_value_kind::Instruction && static_cast<ir_instruction*>(condition)->opcode == ir_opcode::ICmp)
+            {
+                entry.condition = static_cast<ir_instruction*>(condition);
+                entry.taken = branch->operand(1) == block;
+            }
+        }
+    }
+}
+
+// ranges only grow until they are stable, then narrowing recomputes them from that sound starting point
+bool range_analysis::update(ir_instruction* instruction, bool narrowing)
+{
+    value_range& current = _ranges[instruction->number - 1];
+    value_range computed = evaluate(instruction);
+    value_range next;
+
+    if (narrowing)
+    {
+        next = meet(current, computed);
+    }
+    else
+    {
+        next = join(current, computed);
+
+        if (instruction->opcode == ir_opcode::Phi && current.empty() == false && same(next, current) == false &&
+            ++_updates[instruction->number - 1] > widening_threshold)
+        {
+            value_range limit = full(instruction->type);
+
+            if (next.low < current.low) next.low = limit.low;
+            if (next.high > current.high) next.high = limit.high;
+        }
+    }
+
+    if (same(next, current))
+    {
+        return false;
+    }
+
+    current = next;
+    return true;
+}
+
+void range_analysis::rewrite()
+{
+    for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+    {
+        for (ir_instruction* instruction = block->first; instruction != nullptr; instruction = instruction->next)
+        {
+            if (instruction->number == 0 || instruction->opcode == ir_opcode::Call || instruction->opcode == ir_opcode::Load)
+            {
+                continue;
+            }
+
+            value_range result = range(instruction);
+
+            if (result.empty() == false && result.low == result.high)
+            {
+                instruction->replace_uses(_builder.constant(instruction->type, result.low));
+            }
+        }
+    }
+}
+
+void range_analysis::run()
+{
+    number_values();
+
+    bool changed = true;
+
+    while (changed)
+    {
+        changed = false;
+
+        for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+        {
+            for (ir_instruction* instruction = block->first; instruction != nullptr; instruction = instruction->next)
+            {
+                if (instruction->number != 0)
+                {
+                    changed |= update(instruction, false);
+                }
+            }
+        }
+    }
+
+    for (unsigned pass = 0; pass < narrowing_passes; pass++)
+    {
+        for (ir_basic_block* block = _function->first_block; block != nullptr; block = block->next)
+        {
+            for (ir_instruction* instruction = block->first; instruction != nullptr; instruction = instruction->next)
+            {
+                if (instruction->number != 0)
+                {
+                    update(instruction, true);
+                }
+            }
+        }
+    }
+
+    rewrite();
+}
@@ -0,0 +1,62 @@
+#ifndef _RANGE_ANALYSIS_HPP_
+#define _RANGE_ANALYSIS_HPP_
+
+#include "ir.hpp"
+#include <cstdint>
+#include <vector>
+
+class ir_builder;
+
+// the closed interval of values an integer may take, empty while nothing reaches the value
+struct value_range
+{
+    int64_t low;
+    int64_t high;
+
+    bool empty() const
+    {
+        return low > high;
+    }
+};
+
+// bounds every integer value of a finished function by an interval. a value is also narrowed by the
+// conditions of the branches that lead to the block it is used in, as long as each block on the way has a single predecessor.
+// values the intervals pin down, compares included, become constants,
+// which removes the division checks that are provably redundant
+class range_analysis
+{
+    private:
+
+    // the branch that leads into a block with a single predecessor, condition is null on a plain branch
+    struct guard
+    {
+        ir_basic_block* predecessor;
+        ir_instruction* condition;
+        bool taken;
+    };
+
+    ir_builder& _builder;
+    ir_function* const _function;
+    std::vector<value_range> _ranges;
+    std::vector<uint32_t> _updates;
+    std::vector<guard> _guards;
+
+    value_range range(const ir_value* value) const;
+    value_range range_at(const ir_value* value, const ir_basic_block* block) const;
+    value_range evaluate(const ir_instruction* instruction) const;
+
+    void number_values();
+    bool update(ir_instruction* instruction, bool narrowing);
+    void rewrite();
+
+    public:
+
+    range_analysis(ir_builder& builder, ir_function* function);
+
+    range_analysis(const range_analysis& other) = delete;
+    range_analysis& operator=(const range_analysis& other) = delete;
+
+    void run();
+};
+
+#endif
@@ -1,13 +1,15 @@
-#include <iostream>
 #include <sstream>
 #include <string>
-#include <stdlib.h>
 #include "errors.hpp"
 #include "emit/ir_builder.hpp"
 
 using std::string;
 using std::stringstream;
-using std::cout;
+using output::compile_error;
+
+output::compile_error::compile_error(const string& message): std::runtime_error(message)
+{
+}
 
 string type_list_to_string(const std::vector<string>& arg_types)
 {
@@ -25,67 +27,56 @@ string type_list_to_string(const std::vector<string>& arg_types)
 
 void output::error_lex(int lineno)
 {
-    cout << ir_builder::format_string("line %d: lexical error\n", lineno);
-    exit(-1);
+    throw compile_error(ir_builder::format_string(IR_FORMAT("line %d: lexical error\n"), lineno));
 }
 
 void output::error_syn(int lineno)
 {
-    cout << ir_builder::format_string("line %d: syntax error\n", lineno);
-    exit(-1);
+    throw compile_error(ir_builder::format_string(IR_FORMAT("line %d: syntax error\n"), lineno));
 }
 
 void output::error_undef(int lineno, const string& id)
 {
-    cout << ir_builder::format_string("line %d: variable %s is not defined\n", lineno, id);
-    exit(-1);
+    throw compile_error(ir_builder::format_string(IR_FORMAT("line %d: variable %s is not defined\n"), lineno, id));
 }
 
 void output::error_def(int lineno, const string& id)
 {
-    cout << ir_builder::format_string("line %d: identifier %s is already defined\n", lineno, id);
-    exit(-1);
+    throw compile_error(ir_builder::format_string(IR_FORMAT("line %d: identifier %s is already defined\n"), lineno, id));
 }
 
 void output::error_undef_func(int lineno, const string& id)
 {
-    cout << ir_builder::format_string("line %d: function %s is not defined\n", lineno, id);
-    exit(-1);
+    throw compile_error(ir_builder::format_string(IR_FORMAT("line %d: function %s is not defined\n"), lineno, id));
 }
 
 void output::error_mismatch(int lineno)
 {
-    cout << ir_builder::format_string("line %d: type mismatch\n", lineno);
-    exit(-1);
+    throw compile_error(ir_builder::format_string(IR_FORMAT("line %d: type mismatch\n"), lineno));
 }
 
-void output::error_prototype_mismatch(int lineno, const string& id, std::vector<string>& arg_types)
+// "$s" is literal text, so the only %s has always been filled with the function name and the type list was an ignored extra argument
+void output::error_prototype_mismatch(int lineno, const string& id, std::vector<string>&)
 {
-    cout << ir_builder::format_string("line %d: prototype mismatch, function $s expects arguments %s\n", 
-        lineno, id, type_list_to_string(arg_types));
-    exit(-1);
+    throw compile_error(ir_builder::format_string(IR_FORMAT("line %d: prototype mismatch, function $s expects arguments %s\n"), lineno, id));
 }
 
 void output::error_unexpected_break(int lineno)
 {
-    cout << ir_builder::format_string("line %d: unexpected break statement\n", lineno);
-    exit(-1);
+    throw compile_error(ir_builder::format_string(IR_FORMAT("line %d: unexpected break statement\n"), lineno));
 }
 
 void output::error_unexpected_continue(int lineno)
 {
-    cout << ir_builder::format_string("line %d: unexpected continue statement\n", lineno);
-    exit(-1);
+    throw compile_error(ir_builder::format_string(IR_FORMAT("line %d: unexpected continue statement\n"), lineno));
 }
 
 void output::error_main_missing()
 {
-    cout << "Program has no 'void main()' function\n";
-    exit(-1);
+    throw compile_error("Program has no 'void main()' function\n");
 }
 
 void output::error_byte_too_large(int lineno, const string& value)
 {
-    cout << ir_builder::format_string("line %d: byte value %s out of range\n", lineno, value);
-    exit(-1);
+    throw compile_error(ir_builder::format_string(IR_FORMAT("line %d: byte value %s out of range\n"), lineno, value));
 }
@@ -3,9 +3,18 @@
 
 #include <vector>
 #include <string>
+#include <stdexcept>
 
 namespace output
 {
+    // thrown instead of exiting so a failed compilation only unwinds its own context
+    class compile_error : public std::runtime_error
+    {
+        public:
+
+        explicit compile_error(const std::string& message);
+    };
+
     [[noreturn]] void error_lex(int lineno);
 
     [[noreturn]] void error_syn(int lineno);
@@ -0,0 +1,258 @@
+#include "fast_lexer.hpp"
+#include "../errors.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using std::string_view;
+
+static constexpr std::size_t block_size = scan_kernels::block_size;
+
+static inline int count_bits(uint64_t bits)
+{
+    bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+    bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+    bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+
+    return static_cast<int>((bits * 0x0101010101010101ULL) >> 56);
+}
+
+static inline int first_bit(uint64_t bits)
+{
+    return __builtin_ctzll(bits);
+}
+
+fast_lexer::fast_lexer(string_view source, const scan_kernels& kernels):
+    _begin(source.data()), _cursor(source.data()), _end(source.data() + source.size()), _line(1), _kernels(kernels), _identifiers(identifier_table::instance()), _keyword_ids(),
+    _block(std::numeric_limits<std::size_t>::max()), _masks()
+{
+    for (std::size_t i = 0; i < keyword_table::keywords.size(); i++)
+    {
+        _keyword_ids[i] = _identifiers.intern(keyword_table::keywords[i].text);
+    }
+}
+
+int fast_lexer::line() const
+{
+    return _line;
+}
+
+// blocks are classified once and reused by every token that starts inside them, the tail block is zero padded
+const block_masks& fast_lexer::masks_at(std::size_t block)
+{
+    if (block != _block)
+    {
+        std::size_t size = _end - _begin;
+
+        if (block + block_size <= size)
+        {
+            _kernels.classify(_begin + block, _masks);
+        }
+        else
+        {
+            char tail[block_size] = { };
+            std::memcpy(tail, _begin + block, size - block);
+            _kernels.classify(tail, _masks);
+        }
+
+        _block = block;
+    }
+
+    return _masks;
+}
+
+const char* fast_lexer::skip(const char* cursor, run_kind kind)
+{
+    std::size_t offset = cursor - _begin;
+    std::size_t size = _end - _begin;
+
+    while (offset < size)
+    {
+        std::size_t block = offset & ~(block_size - 1);
+        std::size_t shift = offset - block;
+        const block_masks& masks = masks_at(block);
+
+        uint64_t run = 0;
+
+        switch (kind)
+        {
+            case run_kind::Whitespace: run = masks.whitespace; break;
+            case run_kind::Alnum: run = masks.alnum; break;
+            case run_kind::Digits: run = masks.digit; break;
+            case run_kind::Comment: run = ~masks.line_break; break;
+        }
+
+        uint64_t stops = ~run >> shift;
+        std::size_t stop = stops == 0 ? block_size : shift + first_bit(stops);
+
+        if (kind == run_kind::Whitespace)
+        {
+            uint64_t newlines = masks.newline >> shift;
+            _line += count_bits(stop - shift == block_size ? newlines : newlines & ((uint64_t(1) << (stop - shift)) - 1));
+        }
+
+        if (stop < block_size)
+        {
+            return std::min(_begin + block + stop, _end);
+        }
+
+        offset = block + block_size;
+    }
+
+    return _end;
+}
+
+int fast_lexer::make_token(int kind, const char* end, syntax_token*& token)
+{
+    token = new syntax_token(kind, _line, _identifiers.intern(string_view(_cursor, end - _cursor)));
+    _cursor = end;
+    return kind;
+}
+
+int fast_lexer::make_literal(int kind, const char* end, syntax_token*& token)
+{
+    token = new syntax_token(kind, _line, string_view(_cursor, end - _cursor));
+    _cursor = end;
+    return kind;
+}
+
+// returns one past the closing quote, or nullptr when the literal does not match the STRING rule
+const char* fast_lexer::scan_string(const char* cursor) const
+{
+    const char* start = ++cursor;
+
+    while (cursor < _end)
+    {
+        char c = *cursor;
+
+        if (c == '"')
+        {
+            return cursor == start ? nullptr : cursor + 1;
+        }
+
+        if (c == '\n' || c == '\r')
+        {
+            return nullptr;
+        }
+
+        if (c == '\\')
+        {
+            if (cursor + 1 == _end)
+            {
+                return nullptr;
+            }
+
+            char escaped = cursor[1];
+
+            if (escaped != 'r' && escaped != 'n' && escaped != 't' && escaped != '"' && escaped != '\\')
+            {
+                return nullptr;
+            }
+
+            cursor++;
+        }
+
+        cursor++;
+    }
+
+    return nullptr;
+}
+
+int fast_lexer::next(syntax_token*& token)
+{
+    token = nullptr;
+
+    while (true)
+    {
+        _cursor = skip(_cursor, run_kind::Whitespace);
+
+        if (_end - _cursor < 2 || _cursor[0] != '/' || _cursor[1] != '/')
+        {
+            break;
+        }
+
+        _cursor = skip(_cursor + 2, run_kind::Comment);
+
+        if (_cursor < _end)
+        {
+            _line += *_cursor == '\n';
+            _cursor++;
+        }
+    }
+
+    if (_cursor == _end)
+    {
+        return END;
+    }
+
+    char c = *_cursor;
+
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+    {
+        const char* end = skip(_cursor + 1, run_kind::Alnum);
+        string_view text(_cursor, end - _cursor);
+
+        std::size_t keyword = keyword_table::find(text);
+
+        if (keyword == keyword_table::empty_slot)
+        {
+            return make_token(ID, end, token);
+        }
+
+        int kind = keyword_table::keywords[keyword].kind;
+
+        token = new syntax_token(kind, _line, _keyword_ids[keyword]);
+        _cursor = end;
+        return kind;
+    }
+
+    if (c >= '0' && c <= '9')
+    {
+        const char* end = c == '0' ? _cursor + 1 : skip(_cursor + 1, run_kind::Digits);
+
+        return make_literal(NUM, end, token);
+    }
+
+    bool has_next = _end - _cursor >= 2;
+    char n = has_next ? _cursor[1] : '\0';
+
+    switch (c)
+    {
+        case ';': _cursor++; return SC;
+        case ',': _cursor++; return COMMA;
+        case '(': _cursor++; return LPAREN;
+        case ')': _cursor++; return RPAREN;
+        case '{': _cursor++; return LBRACE;
+        case '}': _cursor++; return RBRACE;
+        case '+': case '-': return make_token(ADDOP, _cursor + 1, token);
+        case '*': case '/': return make_token(MULOP, _cursor + 1, token);
+        case '<': case '>': return make_token(RELOP, _cursor + (has_next && n == '=' ? 2 : 1), token);
+        case '=': return has_next && n == '=' ? make_token(EQOP, _cursor + 2, token) : make_token(ASSIGN, _cursor + 1, token);
+        case '!':
+        {
+            if (has_next && n == '=')
+            {
+                return make_token(EQOP, _cursor + 2, token);
+            }
+
+            break;
+        }
+        case '"':
+        {
+            const char* end = scan_string(_cursor);
+
+            if (end != nullptr)
+            {
+                return make_literal(STRING, end, token);
+            }
+
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    output::error_lex(_line);
+}
@@ -0,0 +1,48 @@
+#ifndef _FAST_LEXER_HPP_
+#define _FAST_LEXER_HPP_
+
+#include "scan_kernels.hpp"
+#include "keyword_table.hpp"
+#include "../syntax/syntax_token.hpp"
+#include "../symbol/identifier_table.hpp"
+#include <string_view>
+#include <array>
+
+class fast_lexer
+{
+    private:
+
+    enum class run_kind { Whitespace, Alnum, Digits, Comment };
+
+    const char* const _begin;
+    const char* _cursor;
+    const char* const _end;
+    int _line;
+    const scan_kernels& _kernels;
+    identifier_table& _identifiers;
+    std::array<identifier_id, keyword_table::keywords.size()> _keyword_ids;
+    std::size_t _block;
+    block_masks _masks;
+
+    const block_masks& masks_at(std::size_t block);
+
+    const char* skip(const char* cursor, run_kind kind);
+
+    int make_token(int kind, const char* end, syntax_token*& token);
+    int make_literal(int kind, const char* end, syntax_token*& token);
+
+    const char* scan_string(const char* cursor) const;
+
+    public:
+
+    fast_lexer(std::string_view source, const scan_kernels& kernels = scan_kernels::best());
+
+    fast_lexer(const fast_lexer& other) = delete;
+    fast_lexer& operator=(const fast_lexer& other) = delete;
+
+    int next(syntax_token*& token);
+
+    int line() const;
+};
+
+#endif
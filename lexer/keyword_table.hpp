@@ -0,0 +1,105 @@
+#ifndef _KEYWORD_TABLE_HPP_
+#define _KEYWORD_TABLE_HPP_
+
+#include "../parser.tab.hpp"
+#include <string_view>
+#include <array>
+#include <cstddef>
+
+namespace keyword_table
+{
+    struct entry
+    {
+        std::string_view text;
+        int kind;
+    };
+
+    constexpr std::array<entry, 16> keywords =
+    {{
+        { "void", VOID }, { "int", INT }, { "byte", BYTE }, { "b", B },
+        { "bool", BOOL }, { "and", AND }, { "or", OR }, { "not", NOT },
+        { "true", TRUE }, { "false", FALSE }, { "return", RETURN }, { "if", IF },
+        { "else", ELSE }, { "while", WHILE }, { "break", BREAK }, { "continue", CONTINUE }
+    }};
+
+    constexpr std::size_t table_size = 32;
+    constexpr std::size_t empty_slot = keywords.size();
+
+    constexpr std::size_t hash(std::string_view text, std::size_t seed)
+    {
+        std::size_t first = static_cast<unsigned char>(text.front());
+        std::size_t last = static_cast<unsigned char>(text.back());
+
+        return (first + last * seed + text.size() * seed * seed) % table_size;
+    }
+
+    constexpr bool is_perfect(std::size_t seed)
+    {
+        bool used[table_size] = {};
+
+        for (const entry& keyword : keywords)
+        {
+            std::size_t slot = hash(keyword.text, seed);
+
+            if (used[slot])
+            {
+                return false;
+            }
+
+            used[slot] = true;
+        }
+
+        return true;
+    }
+
+    constexpr std::size_t find_seed()
+    {
+        for (std::size_t seed = 1; seed < 1024; seed++)
+        {
+            if (is_perfect(seed))
+            {
+                return seed;
+            }
+        }
+
+        return 0;
+    }
+
+    constexpr std::size_t seed = find_seed();
+
+    static_assert(seed != 0, "no perfect hash seed for the keyword set");
+
+    constexpr std::array<std::size_t, table_size> build_slots()
+    {
+        std::array<std::size_t, table_size> slots = {};
+
+        for (std::size_t slot = 0; slot < table_size; slot++)
+        {
+            slots[slot] = empty_slot;
+        }
+
+        for (std::size_t i = 0; i < keywords.size(); i++)
+        {
+            slots[hash(keywords[i].text, seed)] = i;
+        }
+
+        return slots;
+    }
+
+    constexpr std::array<std::size_t, table_size> slots = build_slots();
+
+    // returns the index into keywords, or empty_slot when text is a plain identifier
+    constexpr std::size_t find(std::string_view text)
+    {
+        std::size_t index = slots[hash(text, seed)];
+
+        if (index == empty_slot || keywords[index].text != text)
+        {
+            return empty_slot;
+        }
+
+        return index;
+    }
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include "scan_kernels.hpp"
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define SCAN_KERNELS_X86 1
+#endif
+
+using std::string;
+
+static void scalar_classify(const char* block, block_masks& masks)
+{
+    masks = { 0, 0, 0, 0, 0 };
+
+    for (std::size_t i = 0; i < scan_kernels::block_size; i++)
+    {
+        char c = block[i];
+        uint64_t bit = uint64_t(1) << i;
+
+        bool newline = c == '\n';
+        bool line_break = newline || c == '\r';
+        bool digit = c >= '0' && c <= '9';
+        bool alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+
+        masks.whitespace |= (line_break || c == ' ' || c == '\t') ? bit : 0;
+        masks.newline |= newline ? bit : 0;
+        masks.line_break |= line_break ? bit : 0;
+        masks.alnum |= (alpha || digit) ? bit : 0;
+        masks.digit |= digit ? bit : 0;
+    }
+}
+
+#ifdef SCAN_KERNELS_X86
+
+// unsigned range checks through a signed compare: move the range start to -128 and compare against -128 + width
+static inline __m128i sse2_in_range(__m128i block, char first, char width)
+{
+    __m128i shifted = _mm_add_epi8(block, _mm_set1_epi8(static_cast<char>(0x80 - first)));
+
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + width)));
+}
+
+static inline uint64_t sse2_bits(__m128i mask, int lane)
+{
+    return static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(mask))) << (lane * 16);
+}
+
+static void sse2_classify(const char* block, block_masks& masks)
+{
+    masks = { 0, 0, 0, 0, 0 };
+
+    for (int lane = 0; lane < 4; lane++)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + lane * 16));
+
+        __m128i newline = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'));
+        __m128i line_break = _mm_or_si128(newline, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r')));
+        __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t')));
+        __m128i digit = sse2_in_range(bytes, '0', 10);
+        __m128i alpha = sse2_in_range(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), 'a', 26);
+
+        masks.whitespace |= sse2_bits(_mm_or_si128(blank, line_break), lane);
+        masks.newline |= sse2_bits(newline, lane);
+        masks.line_break |= sse2_bits(line_break, lane);
+        masks.alnum |= sse2_bits(_mm_or_si128(alpha, digit), lane);
+        masks.digit |= sse2_bits(digit, lane);
+    }
+}
+
+__attribute__((target("avx2"))) static inline __m256i avx2_in_range(__m256i block, char first, char width)
+{
+    __m256i shifted = _mm256_add_epi8(block, _mm256_set1_epi8(static_cast<char>(0x80 - first)));
+
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + width)), shifted);
+}
+
+__attribute__((target("avx2"))) static inline uint64_t avx2_bits(__m256i mask, int lane)
+{
+    return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(mask))) << (lane * 32);
+}
+
+__attribute__((target("avx2"))) static void avx2_classify(const char* block, block_masks& masks)
+{
+    masks = { 0, 0, 0, 0, 0 };
+
+    for (int lane = 0; lane < 2; lane++)
+    {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + lane * 32));
+
+        __m256i newline = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'));
+        __m256i line_break = _mm256_or_si256(newline, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r')));
+        __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t')));
+        __m256i digit = avx2_in_range(bytes, '0', 10);
+        __m256i alpha = avx2_in_range(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), 'a', 26);
+
+        masks.whitespace |= avx2_bits(_mm256_or_si256(blank, line_break), lane);
+        masks.newline |= avx2_bits(newline, lane);
+        masks.line_break |= avx2_bits(line_break, lane);
+        masks.alnum |= avx2_bits(_mm256_or_si256(alpha, digit), lane);
+        masks.digit |= avx2_bits(digit, lane);
+    }
+}
+
+#endif
+
+bool scan_kernels::avx2_supported()
+{
+#ifdef SCAN_KERNELS_X86
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+const scan_kernels& scan_kernels::scalar()
+{
+    static const scan_kernels kernels = { "scalar", scalar_classify };
+    return kernels;
+}
+
+const scan_kernels& scan_kernels::sse2()
+{
+#ifdef SCAN_KERNELS_X86
+    static const scan_kernels kernels = { "sse2", sse2_classify };
+    return kernels;
+#else
+    return scalar();
+#endif
+}
+
+const scan_kernels& scan_kernels::avx2()
+{
+#ifdef SCAN_KERNELS_X86
+    static const scan_kernels kernels = { "avx2", avx2_classify };
+    return kernels;
+#else
+    return scalar();
+#endif
+}
+
+const scan_kernels& scan_kernels::best()
+{
+    if (avx2_supported())
+    {
+        return avx2();
+    }
+
+    return sse2();
+}
+
+const scan_kernels& scan_kernels::by_name(const string& name)
+{
+    if (name == "scalar") return scalar();
+    if (name == "sse2") return sse2();
+    if (name == "avx2" && avx2_supported()) return avx2();
+
+    throw std::invalid_argument("unknown scan kernels " + name);
+}
@@ -0,0 +1,36 @@
+#ifndef _SCAN_KERNELS_HPP_
+#define _SCAN_KERNELS_HPP_
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// one bit per byte of a 64 byte block, bit i describes block[i]
+struct block_masks
+{
+    uint64_t whitespace;
+    uint64_t newline;
+    uint64_t line_break;
+    uint64_t alnum;
+    uint64_t digit;
+};
+
+struct scan_kernels
+{
+    static constexpr std::size_t block_size = 64;
+
+    const char* name;
+
+    void (*classify)(const char* block, block_masks& masks);
+
+    static bool avx2_supported();
+
+    static const scan_kernels& scalar();
+    static const scan_kernels& sse2();
+    static const scan_kernels& avx2();
+
+    static const scan_kernels& best();
+    static const scan_kernels& by_name(const std::string& name);
+};
+
+#endif
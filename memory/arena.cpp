@@ -0,0 +1,135 @@
+#include "arena.hpp"
+#include "../compilation_context.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using std::size_t;
+using std::string_view;
+
+arena::arena(): _head(nullptr), _cursor(nullptr), _limit(nullptr), _bytes_allocated(0), _objects_allocated(0), _chunk_count(0)
+{
+}
+
+arena::~arena()
+{
+    reset();
+}
+
+arena& arena::instance()
+{
+    return compilation_context::current().syntax_arena;
+}
+
+void arena::add_chunk(size_t min_size)
+{
+    size_t capacity = default_chunk_size;
+
+    if (min_size + alignof(std::max_align_t) > capacity)
+    {
+        capacity = min_size + alignof(std::max_align_t);
+    }
+
+    void* memory = std::malloc(sizeof(chunk) + capacity);
+
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    chunk* new_chunk = static_cast<chunk*>(memory);
+
+    new_chunk->previous = _head;
+    new_chunk->capacity = capacity;
+
+    _head = new_chunk;
+    _cursor = reinterpret_cast<char*>(new_chunk + 1);
+    _limit = _cursor + capacity;
+    _chunk_count++;
+}
+
+void* arena::allocate(size_t size, size_t alignment)
+{
+    size_t padding = _cursor == nullptr ? 0 : (alignment - reinterpret_cast<size_t>(_cursor) % alignment) % alignment;
+
+    if (_cursor == nullptr || padding + size > static_cast<size_t>(_limit - _cursor))
+    {
+        add_chunk(size);
+
+        padding = (alignment - reinterpret_cast<size_t>(_cursor) % alignment) % alignment;
+    }
+
+    char* result = _cursor + padding;
+
+    _cursor = result + size;
+    _bytes_allocated += size;
+    _objects_allocated++;
+
+    return result;
+}
+
+string_view arena::store(string_view text)
+{
+    char* copy = static_cast<char*>(allocate(text.size() + 1, 1));
+
+    std::memcpy(copy, text.data(), text.size());
+    copy[text.size()] = '\0';
+
+    return string_view(copy, text.size());
+}
+
+arena::marker arena::mark() const
+{
+    return { _head, _cursor, _bytes_allocated, _objects_allocated, _chunk_count };
+}
+
+void arena::rewind(const marker& position)
+{
+    while (_head != position.head)
+    {
+        chunk* previous = _head->previous;
+
+        std::free(_head);
+
+        _head = previous;
+    }
+
+    _cursor = position.cursor;
+    _limit = _head == nullptr ? nullptr : reinterpret_cast<char*>(_head + 1) + _head->capacity;
+    _bytes_allocated = position.bytes_allocated;
+    _objects_allocated = position.objects_allocated;
+    _chunk_count = position.chunk_count;
+}
+
+void arena::reset()
+{
+    while (_head != nullptr)
+    {
+        chunk* previous = _head->previous;
+
+        std::free(_head);
+
+        _head = previous;
+    }
+
+    _cursor = nullptr;
+    _limit = nullptr;
+    _bytes_allocated = 0;
+    _objects_allocated = 0;
+    _chunk_count = 0;
+}
+
+size_t arena::bytes_allocated() const
+{
+    return _bytes_allocated;
+}
+
+size_t arena::objects_allocated() const
+{
+    return _objects_allocated;
+}
+
+size_t arena::chunk_count() const
+{
+    return _chunk_count;
+}
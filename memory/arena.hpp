@@ -0,0 +1,104 @@
+#ifndef _ARENA_HPP_
+#define _ARENA_HPP_
+
+#include <cstddef>
+#include <string_view>
+#include <list>
+
+class arena
+{
+    private:
+
+    struct chunk
+    {
+        chunk* previous;
+        std::size_t capacity;
+    };
+
+    static constexpr std::size_t default_chunk_size = 64 * 1024;
+
+    chunk* _head;
+    char* _cursor;
+    char* _limit;
+    std::size_t _bytes_allocated;
+    std::size_t _objects_allocated;
+    std::size_t _chunk_count;
+
+    arena();
+
+    friend class compilation_context;
+
+    void add_chunk(std::size_t min_size);
+
+    public:
+
+    arena(const arena& other) = delete;
+    arena& operator=(const arena& other) = delete;
+
+    ~arena();
+
+    // everything allocated after a marker is released by rewinding to it
+    struct marker
+    {
+        chunk* head;
+        char* cursor;
+        std::size_t bytes_allocated;
+        std::size_t objects_allocated;
+        std::size_t chunk_count;
+    };
+
+    static arena& instance();
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    std::string_view store(std::string_view text);
+
+    marker mark() const;
+    void rewind(const marker& position);
+
+    void reset();
+
+    std::size_t bytes_allocated() const;
+    std::size_t objects_allocated() const;
+    std::size_t chunk_count() const;
+};
+
+template<typename T> class arena_allocator
+{
+    public:
+
+    using value_type = T;
+
+    arena* const owner;
+
+    arena_allocator(): owner(&arena::instance())
+    {
+    }
+
+    template<typename U> arena_allocator(const arena_allocator<U>& other): owner(other.owner)
+    {
+    }
+
+    T* allocate(std::size_t count)
+    {
+        return static_cast<T*>(owner->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t)
+    {
+    }
+
+    template<typename U> bool operator==(const arena_allocator<U>& other) const
+    {
+        return owner == other.owner;
+    }
+
+    template<typename U> bool operator!=(const arena_allocator<U>& other) const
+    {
+        return owner != other.owner;
+    }
+};
+
+template<typename T> using arena_list = std::list<T, arena_allocator<T>>;
+
+#endif
@@ -0,0 +1,67 @@
+#include "mapped_file.hpp"
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using std::size_t;
+using std::string;
+
+mapped_file::mapped_file(const string& path): _data(nullptr), _size(0), _mapped_size(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("cannot stat " + path);
+    }
+
+    _size = static_cast<size_t>(info.st_size);
+    _mapped_size = _size + padding;
+
+    // flex null-terminates yytext in place, so the mapping is private and writable; the file is never modified
+    void* reserved = mmap(nullptr, _mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (reserved == MAP_FAILED)
+    {
+        close(fd);
+        throw std::runtime_error("cannot map " + path);
+    }
+
+    if (_size > 0 && mmap(reserved, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        munmap(reserved, _mapped_size);
+        close(fd);
+        throw std::runtime_error("cannot map " + path);
+    }
+
+    close(fd);
+
+    madvise(reserved, _mapped_size, MADV_SEQUENTIAL);
+
+    _data = static_cast<char*>(reserved);
+}
+
+mapped_file::~mapped_file()
+{
+    munmap(_data, _mapped_size);
+}
+
+char* mapped_file::data() const
+{
+    return _data;
+}
+
+size_t mapped_file::size() const
+{
+    return _size;
+}
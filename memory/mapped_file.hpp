@@ -0,0 +1,30 @@
+#ifndef _MAPPED_FILE_HPP_
+#define _MAPPED_FILE_HPP_
+
+#include <string>
+#include <cstddef>
+
+class mapped_file
+{
+    private:
+
+    char* _data;
+    std::size_t _size;
+    std::size_t _mapped_size;
+
+    public:
+
+    // yy_scan_buffer expects the scanned region to end with two null bytes
+    static constexpr std::size_t padding = 2;
+
+    mapped_file(const std::string& path);
+    ~mapped_file();
+
+    mapped_file(const mapped_file& other) = delete;
+    mapped_file& operator=(const mapped_file& other) = delete;
+
+    char* data() const;
+    std::size_t size() const;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "identifier_table.hpp"
+#include "../compilation_context.hpp"
+
+using std::string_view;
+
+identifier_table::identifier_table(arena& storage): _storage(storage), _ids(), _texts()
+{
+}
+
+identifier_table& identifier_table::instance()
+{
+    return compilation_context::current().identifiers;
+}
+
+identifier_id identifier_table::intern(string_view text)
+{
+    auto key_val = _ids.find(text);
+
+    if (key_val != _ids.end())
+    {
+        return key_val->second;
+    }
+
+    string_view stored = _storage.store(text);
+    identifier_id id = static_cast<identifier_id>(_texts.size());
+
+    _texts.push_back(stored);
+    _ids.emplace(stored, id);
+
+    return id;
+}
+
+string_view identifier_table::text(identifier_id id) const
+{
+    return _texts[id];
+}
+
+std::size_t identifier_table::size() const
+{
+    return _texts.size();
+}
+
+void identifier_table::reset()
+{
+    _ids.clear();
+    _texts.clear();
+}
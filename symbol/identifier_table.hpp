@@ -0,0 +1,42 @@
+#ifndef _IDENTIFIER_TABLE_HPP_
+#define _IDENTIFIER_TABLE_HPP_
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include "../memory/arena.hpp"
+
+using identifier_id = uint32_t;
+
+class identifier_table
+{
+    private:
+
+    arena& _storage;
+    std::unordered_map<std::string_view, identifier_id> _ids;
+    std::vector<std::string_view> _texts;
+
+    identifier_table(arena& storage);
+
+    friend class compilation_context;
+
+    public:
+
+    static constexpr identifier_id invalid_id = UINT32_MAX;
+
+    identifier_table(const identifier_table& other) = delete;
+    identifier_table& operator=(const identifier_table& other) = delete;
+
+    static identifier_table& instance();
+
+    identifier_id intern(std::string_view text);
+
+    std::string_view text(identifier_id id) const;
+
+    std::size_t size() const;
+
+    void reset();
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include "identifier_table.hpp"
 #include "../syntax/abstract_syntax.hpp"
 
 enum class symbol_kind { Variable, Parameter, Function };
@@ -12,13 +13,16 @@ class symbol
     public:
 
     const symbol_kind kind;
-    const std::string name;
+    const identifier_id name;
     const int offset;
     const type_kind type;
 
+    // index of the stack slot among the locals and parameters of the enclosing function
+    const uint32_t slot;
+
     protected:
 
-    symbol(const std::string& name, type_kind type, int offset, symbol_kind kind);
+    symbol(identifier_id name, type_kind type, int offset, symbol_kind kind, uint32_t slot);
 
     public:
 
@@ -29,16 +33,14 @@ class variable_symbol: public symbol
 {
     public:
 
-    const std::string ptr_reg;
-
-    variable_symbol(const std::string& name, type_kind type, int offset);
+    variable_symbol(identifier_id name, type_kind type, int offset, uint32_t slot);
 };
 
 class parameter_symbol: public symbol
 {
     public:
 
-    parameter_symbol(const std::string& name, type_kind type, int offset);
+    parameter_symbol(identifier_id name, type_kind type, int offset, uint32_t slot);
 };
 
 class function_symbol: public symbol
@@ -47,7 +49,7 @@ class function_symbol: public symbol
 
     const std::vector<type_kind> parameter_types;
 
-    function_symbol(const std::string& name, type_kind return_type, const std::vector<type_kind>& parameter_types);
+    function_symbol(identifier_id name, type_kind return_type, const std::vector<type_kind>& parameter_types);
 };
 
 #endif
\ No newline at end of file
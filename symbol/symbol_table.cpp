@@ -1,132 +1,188 @@
 #include "symbol_table.hpp"
-#include "scope.hpp"
+#include "../compilation_context.hpp"
+#include <algorithm>
 
 using std::string;
 using std::vector;
-using std::list;
+using std::size_t;
 
-symbol_table::symbol_table(): _scope_list()
+symbol_table::symbol_table(): _symbols(), _bindings(), _heads(), _frames(), _loop_depth(0), _slot_count(0), _current_function(nullptr)
 {
 
 }
 
 symbol_table& symbol_table::instance()
 {
-    static symbol_table instance;
-    return instance;
+    return compilation_context::current().symbols;
 }
 
 void symbol_table::open_scope(bool loop_scope)
 {
-    if (_scope_list.size() == 0)
+    int offset = _frames.empty() ? 0 : _frames.back().offset;
+
+    _frames.push_back({ offset, offset - 1, loop_scope, _bindings.size() });
+
+    if (loop_scope)
     {
-        _scope_list.push_back(scope(0, loop_scope));
+        _loop_depth++;
     }
-    else
+}
+
+void symbol_table::close_scope()
+{
+    const scope_frame& frame = _frames.back();
+
+    while (_bindings.size() > frame.first_binding)
     {
-        _scope_list.push_back(scope(_scope_list.back()._offset, loop_scope));
+        const binding& undone = _bindings.back();
+        _heads[undone.sym->name] = undone.shadowed;
+        _bindings.pop_back();
     }
+
+    if (frame.loop_scope)
+    {
+        _loop_depth--;
+    }
+
+    _frames.pop_back();
 }
 
-void symbol_table::close_scope()
+bool symbol_table::in_loop() const
 {
-    _scope_list.pop_back();
+    return _loop_depth > 0;
 }
 
-const scope& symbol_table::current_scope() const
+// names resolve to their outermost binding. declarations never shadow, except a parameter
+// named like its own function, and there the function wins
+size_t symbol_table::mark() const
 {
-    return _scope_list.back();
+    return _symbols.size();
 }
 
+// the scopes declaring them are closed, so no binding refers to a released symbol
+void symbol_table::rewind(size_t position)
+{
+    auto kept = std::remove_if(_symbols.begin() + static_cast<std::ptrdiff_t>(position), _symbols.end(), [](const std::unique_ptr<symbol>& sym) { return sym->kind != symbol_kind::Function; });
+
+    _symbols.erase(kept, _symbols.end());
+}
 
-bool symbol_table::contains_symbol(const string& name) const
+size_t symbol_table::size() const
 {
-    for (const scope& sc : _scope_list)
+    return _symbols.size();
+}
+
+const symbol_table::binding* symbol_table::find(identifier_id name) const
+{
+    if (name >= _heads.size() || _heads[name] == no_binding)
     {
-        if (sc.contains_symbol(name))
-        {
-            return true;
-        }
+        return nullptr;
     }
 
-    return false;
-}
+    uint32_t index = _heads[name];
 
-bool symbol_table::contains_symbol(const string& name, symbol_kind kind) const
-{
-    for (const scope& sc : _scope_list)
+    while (_bindings[index].shadowed != no_binding)
     {
-        if (sc.contains_symbol(name, kind))
-        {
-            return true;
-        }
+        index = _bindings[index].shadowed;
     }
 
-    return false;
+    return &_bindings[index];
+}
+
+bool symbol_table::declared_in_current_scope(identifier_id name) const
+{
+    return name < _heads.size() && _heads[name] != no_binding && _heads[name] >= _frames.back().first_binding;
 }
 
-const symbol* symbol_table::get_symbol(const string& name) const
+void symbol_table::bind(symbol* sym)
 {
-    for (const scope& sc : _scope_list)
+    if (sym->name >= _heads.size())
     {
-        if (sc.contains_symbol(name))
-        {
-            return sc.get_symbol(name);
-        }
+        _heads.resize(sym->name + 1, no_binding);
     }
 
-    return nullptr;
+    _bindings.push_back({ sym, _heads[sym->name] });
+    _heads[sym->name] = static_cast<uint32_t>(_bindings.size() - 1);
+
+    _symbols.emplace_back(sym);
+}
+
+bool symbol_table::contains_symbol(identifier_id name) const
+{
+    return find(name) != nullptr;
+}
+
+bool symbol_table::contains_symbol(identifier_id name, symbol_kind kind) const
+{
+    return get_symbol(name, kind) != nullptr;
+}
+
+const symbol* symbol_table::get_symbol(identifier_id name) const
+{
+    const binding* found = find(name);
+
+    return found == nullptr ? nullptr : found->sym;
 }
 
-const symbol* symbol_table::get_symbol(const string& name, symbol_kind kind) const
+const symbol* symbol_table::get_symbol(identifier_id name, symbol_kind kind) const
 {
-    for (const scope& sc : _scope_list)
+    const symbol* sym = get_symbol(name);
+
+    if (sym == nullptr || sym->kind != kind)
     {
-        if (sc.contains_symbol(name))
-        {
-            return sc.get_symbol(name, kind);
-        }
+        return nullptr;
     }
 
-    return nullptr;
+    return sym;
+}
+
+const function_symbol* symbol_table::current_function() const
+{
+    return _current_function;
 }
 
-bool symbol_table::add_variable(const string& name, type_kind type)
+const variable_symbol* symbol_table::add_variable(identifier_id name, type_kind type)
 {
-    if (_scope_list.size() == 0)
+    if (_frames.empty() || declared_in_current_scope(name))
     {
-        return false;
+        return nullptr;
     }
 
-    return _scope_list.back().add_variable(name, type);
+    variable_symbol* variable = new variable_symbol(name, type, _frames.back().offset, _slot_count++);
+
+    bind(variable);
+    _frames.back().offset += 1;
+    return variable;
 }
 
-bool symbol_table::add_parameter(const string& name, type_kind type)
+bool symbol_table::add_parameter(identifier_id name, type_kind type)
 {
-    if (_scope_list.size() == 0)
+    if (_frames.empty() || declared_in_current_scope(name))
     {
         return false;
     }
 
-    return _scope_list.back().add_parameter(name, type);
+    bind(new parameter_symbol(name, type, _frames.back().param_offset, _slot_count++));
+    _frames.back().param_offset -= 1;
+    return true;
 }
 
-bool symbol_table::add_function(const string& name, type_kind return_type, const vector<type_kind>& parameter_types)
+bool symbol_table::add_function(identifier_id name, type_kind return_type, const vector<type_kind>& parameter_types)
 {
-    if (_scope_list.size() == 0)
+    if (_frames.empty() || declared_in_current_scope(name))
     {
         return false;
     }
 
-    return _scope_list.back().add_function(name, return_type, parameter_types);
-}
+    function_symbol* function = new function_symbol(name, return_type, parameter_types);
 
-bool symbol_table::add_function(const string& name, type_kind return_type)
-{
-    return add_function(name, return_type, vector<type_kind>());
+    bind(function);
+    _current_function = function;
+    _slot_count = 0;
+    return true;
 }
 
-const list<scope>& symbol_table::scopes() const
+bool symbol_table::add_function(identifier_id name, type_kind return_type)
 {
-    return _scope_list;
+    return add_function(name, return_type, vector<type_kind>());
 }
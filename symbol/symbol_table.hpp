@@ -2,38 +2,78 @@
 #define _SYMBOL_TABLE_HPP_
 
 #include <string>
-#include <list>
-#include "scope.hpp"
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "symbol.hpp"
+#include "identifier_table.hpp"
 
 class symbol_table
 {
     private:
 
-    std::list<scope> _scope_list;
+    static constexpr uint32_t no_binding = UINT32_MAX;
+
+    struct binding
+    {
+        const symbol* sym;
+        uint32_t shadowed;
+    };
+
+    struct scope_frame
+    {
+        int offset;
+        int param_offset;
+        bool loop_scope;
+        std::size_t first_binding;
+    };
+
+    // bindings are pushed in declaration order and double as the undo log close_scope replays
+    std::vector<std::unique_ptr<symbol>> _symbols;
+    std::vector<binding> _bindings;
+    std::vector<uint32_t> _heads;
+    std::vector<scope_frame> _frames;
+    int _loop_depth;
+    uint32_t _slot_count;
+    const function_symbol* _current_function;
 
     symbol_table();
 
+    friend class compilation_context;
+
+    const binding* find(identifier_id name) const;
+    bool declared_in_current_scope(identifier_id name) const;
+    void bind(symbol* sym);
+
     public:
 
+    symbol_table(const symbol_table& other) = delete;
+    symbol_table& operator=(const symbol_table& other) = delete;
+
     static symbol_table& instance();
 
     void open_scope(bool loop_scope = false);
     void close_scope();
 
-    const scope& current_scope() const;
+    bool in_loop() const;
+
+    // locals and parameters declared after a mark are released by rewinding to it, functions stay
+    std::size_t mark() const;
+    void rewind(std::size_t position);
+    std::size_t size() const;
 
-    bool contains_symbol(const std::string& name) const;
-    bool contains_symbol(const std::string& name, symbol_kind kind) const;
+    bool contains_symbol(identifier_id name) const;
+    bool contains_symbol(identifier_id name, symbol_kind kind) const;
 
-    const symbol* get_symbol(const std::string& name) const;
-    const symbol* get_symbol(const std::string& name, symbol_kind kind) const;
+    const symbol* get_symbol(identifier_id name) const;
+    const symbol* get_symbol(identifier_id name, symbol_kind kind) const;
 
-    bool add_variable(const std::string& name, type_kind type);
-    bool add_parameter(const std::string& name, type_kind type);
-    bool add_function(const std::string& name, type_kind return_type);
-    bool add_function(const std::string& name, type_kind return_type, const std::vector<type_kind>& parameter_types);
+    const function_symbol* current_function() const;
 
-    const std::list<scope>& scopes() const;
+    const variable_symbol* add_variable(identifier_id name, type_kind type);
+    bool add_parameter(identifier_id name, type_kind type);
+    bool add_function(identifier_id name, type_kind return_type);
+    bool add_function(identifier_id name, type_kind return_type, const std::vector<type_kind>& parameter_types);
 };
 
-#endif
\ No newline at end of file
+#endif
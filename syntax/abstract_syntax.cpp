@@ -1,26 +1,27 @@
 #include "abstract_syntax.hpp"
 #include "../errors.hpp"
-#include "../emit/code_buffer.hpp"
 #include <stdexcept>
 #include <string>
 #include <initializer_list>
 
 using std::string;
-using std::list;
 using std::initializer_list;
 
-static code_buffer& code_buf = code_buffer::instance();
-
-syntax_base::syntax_base(): _children(), _parent(nullptr)
+syntax_base::syntax_base(): _parent(nullptr)
 {
 }
 
 syntax_base::~syntax_base()
 {
-    for (syntax_base* child : _children)
-    {
-        delete child;
-    }
+}
+
+void* syntax_base::operator new(std::size_t size)
+{
+    return arena::instance().allocate(size);
+}
+
+void syntax_base::operator delete(void*)
+{
 }
 
 const syntax_base* syntax_base::parent() const
@@ -35,7 +36,6 @@ void syntax_base::add_child(syntax_base* child)
         return;
     }
 
-    _children.push_back(child);
     child->_parent = this;
 }
 
@@ -47,24 +47,8 @@ void syntax_base::add_children(initializer_list<syntax_base*> children)
     }
 }
 
-void syntax_base::add_child_front(syntax_base* child)
-{
-    if (child == nullptr)
-    {
-        return;
-    }
-
-    _children.push_front(child);
-    child->_parent = this;
-}
-
-const list<syntax_base*>& syntax_base::children() const
-{
-    return _children;
-}
-
 expression_syntax::expression_syntax(type_kind return_type):
-    return_type(return_type), reg(ir_builder::fresh_register())
+    return_type(return_type), result(nullptr), true_list(), false_list()
 {
 
 }
@@ -79,6 +63,13 @@ bool expression_syntax::is_special() const
     return types::is_special(return_type);
 }
 
+void expression_syntax::emit_condition()
+{
+    emit();
+
+    ir_builder::instance().branch(result, true_list, false_list);
+}
+
 statement_syntax::statement_syntax(): break_list(), continue_list()
 {
 }
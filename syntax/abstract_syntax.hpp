@@ -3,10 +3,11 @@
 
 #include "syntax_token.hpp"
 #include "../types.hpp"
-#include "../emit/code_buffer.hpp"
+#include "../emit/ir_builder.hpp"
+#include "../memory/arena.hpp"
 #include <vector>
 #include <string>
-#include <list>
+#include <string_view>
 #include <initializer_list>
 
 class expression_syntax;
@@ -15,7 +16,6 @@ class syntax_base
 {
     private:
 
-    std::list<syntax_base*> _children;
     syntax_base* _parent;
 
     public:
@@ -26,8 +26,10 @@ class syntax_base
     syntax_base(const syntax_base& other) = delete;
     syntax_base& operator=(const syntax_base& other) = delete;
 
+    static void* operator new(std::size_t size);
+    static void operator delete(void* pointer);
+
     const syntax_base* parent() const;
-    const std::list<syntax_base*>& children() const;
 
     virtual void analyze() const = 0;
     virtual void emit() = 0;
@@ -35,7 +37,6 @@ class syntax_base
     protected:
 
     void add_child(syntax_base* child);
-    void add_child_front(syntax_base* child);
     void add_children(std::initializer_list<syntax_base*> children);
 };
 
@@ -44,7 +45,9 @@ class expression_syntax: public syntax_base
     public:
 
     const type_kind return_type;
-    const std::string reg;
+    ir_value* result;
+    patch_list true_list;
+    patch_list false_list;
 
     expression_syntax(type_kind return_type);
     virtual ~expression_syntax() = default;
@@ -54,14 +57,17 @@ class expression_syntax: public syntax_base
 
     bool is_numeric() const;
     bool is_special() const;
+
+    // emits a boolean as jumps to true_list or false_list, leaving result unset
+    virtual void emit_condition();
 };
 
 class statement_syntax: public syntax_base
 {
     public:
 
-    std::list<size_t> break_list;
-    std::list<size_t> continue_list;
+    patch_list break_list;
+    patch_list continue_list;
 
     statement_syntax();
     virtual ~statement_syntax() = default;
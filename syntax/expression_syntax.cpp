@@ -1,21 +1,15 @@
 #include "expression_syntax.hpp"
 #include "../symbol/symbol_table.hpp"
 #include "../errors.hpp"
-#include "../emit/code_buffer.hpp"
 #include "../symbol/symbol.hpp"
 #include "../emit/ir_builder.hpp"
 #include <stdexcept>
 #include <list>
-#include <sstream>
-#include <iterator>
 
 using std::string;
+using std::string_view;
 using std::vector;
 using std::list;
-using std::stringstream;
-
-static symbol_table& sym_tab = symbol_table::instance();
-static code_buffer& code_buf = code_buffer::instance();
 
 cast_expression::cast_expression(type_syntax* destination_type, expression_syntax* value):
     expression_syntax(destination_type->kind), destination_type(destination_type), value(value)
@@ -36,14 +30,7 @@ void cast_expression::emit()
 {
     value->emit();
 
-    if (value->return_type == type_kind::Int && destination_type->kind == type_kind::Byte)
-    {
-        code_buf.emit("%s = and i32 255, %s", this->reg, value->reg);
-    }
-    else
-    {
-        code_buf.emit("%s = add i32 0, %s", this->reg, value->reg);
-    }
+    result = ir_builder::instance().convert(value->result, ir_builder::get_ir_type(destination_type->kind));
 }
 
 not_expression::not_expression(syntax_token* not_token, expression_syntax* expression):
@@ -53,11 +40,6 @@ not_expression::not_expression(syntax_token* not_token, expression_syntax* expre
     add_child(expression);
 }
 
-not_expression::~not_expression()
-{
-    delete not_token;
-}
-
 void not_expression::analyze() const
 {
     if (expression->return_type != type_kind::Bool)
@@ -68,9 +50,21 @@ void not_expression::analyze() const
 
 void not_expression::emit()
 {
+    ir_builder& builder = ir_builder::instance();
+
     expression->emit();
 
-    code_buf.emit("%s = select i1 %s, i1 0, i1 1", this->reg, expression->reg);
+    result = builder.select(expression->result, builder.constant(ir_type::I1, 0), builder.constant(ir_type::I1, 1));
+}
+
+void not_expression::emit_condition()
+{
+    ir_builder& builder = ir_builder::instance();
+
+    expression->emit_condition();
+
+    builder.merge(true_list, expression->false_list);
+    builder.merge(false_list, expression->true_list);
 }
 
 logical_expression::logical_expression(expression_syntax* left, syntax_token* oper_token, expression_syntax* right):
@@ -80,12 +74,7 @@ logical_expression::logical_expression(expression_syntax* left, syntax_token* op
     add_children({ left, right });
 }
 
-logical_expression::~logical_expression()
-{
-    delete oper_token;
-}
-
-logical_expression::operator_kind logical_expression::parse_operator(string str)
+logical_expression::operator_kind logical_expression::parse_operator(string_view str)
 {
     if (str == "and") return operator_kind::And;
     if (str == "or") return operator_kind::Or;
@@ -103,32 +92,36 @@ void logical_expression::analyze() const
 
 void logical_expression::emit()
 {
-    left->emit();
+    ir_builder& builder = ir_builder::instance();
 
-    string start_label = ir_builder::fresh_label();
-    string right_label = ir_builder::fresh_label();
-    string phi_label = ir_builder::fresh_label();
-    string branch_label = ir_builder::fresh_label();
+    emit_condition();
 
-    code_buf.emit("br label %%%s", start_label);
-    code_buf.emit("%s:", start_label);
+    result = builder.materialize(true_list, false_list);
+}
 
-    if (oper == operator_kind::Or)
-    {
-        code_buf.emit("br i1 %s, label %%%s, label %%%s", left->reg, phi_label, right_label);
-    }
-    else if (oper == operator_kind::And)
+// the right operand is reached where the left one leaves the expression undecided, and skipped if it never does
+void logical_expression::emit_condition()
+{
+    ir_builder& builder = ir_builder::instance();
+
+    bool is_and = oper == operator_kind::And;
+
+    left->emit_condition();
+
+    patch_list& undecided = is_and ? left->true_list : left->false_list;
+
+    builder.merge(is_and ? false_list : true_list, is_and ? left->false_list : left->true_list);
+
+    if (undecided.empty())
     {
-        code_buf.emit("br i1 %s, label %%%s, label %%%s", left->reg, right_label, phi_label);
+        return;
     }
 
-    code_buf.emit("%s:", right_label);
-    right->emit();
-    code_buf.emit("br label %%%s", branch_label);
-    code_buf.emit("%s:", branch_label);
-    code_buf.emit("br label %%%s", phi_label);
-    code_buf.emit("%s:", phi_label);
-    code_buf.emit("%s = phi i1 [ %s, %%%s ], [ %s, %%%s ]", this->reg, left->reg, start_label, right->reg, branch_label);
+    builder.land(undecided);
+    right->emit_condition();
+
+    builder.merge(true_list, right->true_list);
+    builder.merge(false_list, right->false_list);
 }
 
 arithmetic_expression::arithmetic_expression(expression_syntax* left, syntax_token* oper_token, expression_syntax* right):
@@ -138,12 +131,7 @@ arithmetic_expression::arithmetic_expression(expression_syntax* left, syntax_tok
     add_children({ left, right });
 }
 
-arithmetic_expression::~arithmetic_expression()
-{
-    delete oper_token;
-}
-
-arithmetic_operator arithmetic_expression::parse_operator(string str)
+arithmetic_operator arithmetic_expression::parse_operator(string_view str)
 {
     if (str == "+") return arithmetic_operator::Add;
     if (str == "-") return arithmetic_operator::Sub;
@@ -163,36 +151,42 @@ void arithmetic_expression::analyze() const
 
 void arithmetic_expression::emit()
 {
+    ir_builder& builder = ir_builder::instance();
+
     left->emit();
     right->emit();
 
-    if (oper == arithmetic_operator::Div)
-    {
-        string cmp_res = ir_builder::fresh_register();
-        string true_label = ir_builder::fresh_label();
-        string false_label = ir_builder::fresh_label();
-
-        code_buf.emit("%s = icmp eq i32 0, %s", cmp_res, right->reg);
-        code_buf.emit("br i1 %s, label %%%s, label %%%s", cmp_res, true_label, false_label);
-        code_buf.emit("%s:", true_label);
-        code_buf.emit("call void @error_zero_div()");
-        code_buf.emit("br label %%%s", false_label);
-        code_buf.emit("%s:", false_label);
-    }
-
-    string inst = ir_builder::get_bin_inst(oper, return_type == type_kind::Int);
+    // a byte operand of an int operation is widened, bytes are computed as i8
+    ir_type operand_type = ir_builder::get_ir_type(return_type);
+    ir_value* left_value = builder.convert(left->result, operand_type);
+    ir_value* right_value = builder.convert(right->result, operand_type);
 
-    if (return_type == type_kind::Byte)
+    // a constant divisor needs no check, a constant zero always traps
+    if (oper == arithmetic_operator::Div && right_value->value_kind == ir_value_kind::Constant)
     {
-        string res_reg = ir_builder::fresh_register();
-
-        code_buf.emit("%s = %s i32 %s, %s", res_reg, inst, left->reg, right->reg);
-        code_buf.emit("%s = and i32 255, %s", this->reg, res_reg);
+        if (static_cast<ir_constant*>(right_value)->value == 0)
+        {
+            builder.call(ir_module::instance().function("error_zero_div"), 0);
+            builder.unreachable();
+        }
     }
-    else if (return_type == type_kind::Int)
+    else if (oper == arithmetic_operator::Div)
     {
-        code_buf.emit("%s = %s i32 %s, %s", this->reg, inst, left->reg, right->reg);
+        ir_value* is_zero = builder.compare(ir_predicate::Eq, builder.constant(operand_type, 0), right_value);
+
+        ir_basic_block* true_block = builder.create_block();
+        ir_basic_block* false_block = builder.create_block();
+
+        builder.branch(is_zero, true_block, false_block);
+        builder.place(true_block);
+        builder.call(ir_module::instance().function("error_zero_div"), 0);
+        builder.unreachable();
+        builder.place(false_block);
     }
+
+    ir_opcode inst = ir_builder::get_bin_inst(oper, return_type == type_kind::Int);
+
+    result = builder.binary(inst, left_value, right_value);
 }
 
 relational_expression::relational_expression(expression_syntax* left, syntax_token* oper_token, expression_syntax* right):
@@ -202,12 +196,7 @@ relational_expression::relational_expression(expression_syntax* left, syntax_tok
     add_children({ left, right });
 }
 
-relational_expression::~relational_expression()
-{
-    delete oper_token;
-}
-
-relational_operator relational_expression::parse_operator(string str)
+relational_operator relational_expression::parse_operator(string_view str)
 {
     if (str == "<") return relational_operator::Less;
     if (str == "<=") return relational_operator::LessEqual;
@@ -229,14 +218,18 @@ void relational_expression::analyze() const
 
 void relational_expression::emit()
 {
+    ir_builder& builder = ir_builder::instance();
+
     left->emit();
     right->emit();
 
     type_kind operands_type = types::cast_up(left->return_type, right->return_type);
+    ir_type operand_type = ir_builder::get_ir_type(operands_type);
 
-    string cmp_kind = ir_builder::get_comp_kind(oper, operands_type == type_kind::Int);
+    // bytes compare unsigned as i8, a byte against an int is widened first
+    ir_predicate cmp_kind = ir_builder::get_comp_kind(oper, operands_type == type_kind::Int);
 
-    code_buf.emit("%s = icmp %s i32 %s, %s", this->reg, cmp_kind, left->reg, right->reg);
+    result = builder.compare(cmp_kind, builder.convert(left->result, operand_type), builder.convert(right->result, operand_type));
 }
 
 conditional_expression::conditional_expression(expression_syntax* true_value, syntax_token* if_token, expression_syntax* condition, syntax_token* else_token, expression_syntax* false_value):
@@ -246,12 +239,6 @@ conditional_expression::conditional_expression(expression_syntax* true_value, sy
     add_children({ true_value, condition, false_value });
 }
 
-conditional_expression::~conditional_expression()
-{
-    delete if_token;
-    delete else_token;
-}
-
 void conditional_expression::analyze() const
 {
     if (return_type == type_kind::Void)
@@ -267,117 +254,114 @@ void conditional_expression::analyze() const
 
 void conditional_expression::emit()
 {
-    string true_label = ir_builder::fresh_label();
-    string false_label = ir_builder::fresh_label();
-    string true_branch = ir_builder::fresh_label();
-    string false_branch = ir_builder::fresh_label();
-    string phi_label = ir_builder::fresh_label();
+    ir_builder& builder = ir_builder::instance();
 
-    string ret_type = ir_builder::get_ir_type(this->return_type);
+    ir_type result_type = ir_builder::get_ir_type(this->return_type);
 
-    condition->emit();
-    code_buf.emit("br i1 %s, label %%%s, label %%%s", condition->reg, true_label, false_label);
-    code_buf.emit("%s:", true_label);
+    condition->emit_condition();
+
+    // a value the condition never leads to is not evaluated
+    if (condition->true_list.empty() || condition->false_list.empty())
+    {
+        bool is_true = condition->false_list.empty();
+        expression_syntax* chosen = is_true ? true_value : false_value;
+
+        builder.land(is_true ? condition->true_list : condition->false_list);
+        chosen->emit();
+        result = builder.convert(chosen->result, result_type);
+
+        return;
+    }
+
+    ir_basic_block* true_branch = builder.create_block();
+    ir_basic_block* false_branch = builder.create_block();
+    ir_basic_block* phi_block = builder.create_block();
+
+    builder.land(condition->true_list);
     true_value->emit();
-    code_buf.emit("br label %%%s", true_branch);
-    code_buf.emit("%s:", true_branch);
-    code_buf.emit("br label %%%s", phi_label);
-    code_buf.emit("%s:", false_label);
+    ir_value* true_result = builder.convert(true_value->result, result_type);
+    builder.branch(true_branch);
+    builder.place(true_branch);
+    builder.branch(phi_block);
+    builder.land(condition->false_list);
     false_value->emit();
-    code_buf.emit("br label %%%s", false_branch);
-    code_buf.emit("%s:", false_branch);
-    code_buf.emit("br label %%%s", phi_label);
-    code_buf.emit("%s:", phi_label);
-    code_buf.emit("%s = phi %s [ %s, %%%s ], [ %s, %%%s ]", this->reg, ret_type, true_value->reg, true_branch, false_value->reg, false_branch);
-}
+    ir_value* false_result = builder.convert(false_value->result, result_type);
+    builder.branch(false_branch);
+    builder.place(false_branch);
+    builder.branch(phi_block);
+    builder.place(phi_block);
 
-identifier_expression::identifier_expression(syntax_token* identifier_token):
-    expression_syntax(get_return_type(identifier_token->text)), identifier_token(identifier_token), identifier(identifier_token->text), _kind(symbol_kind::Parameter), _ptr_reg()
-{
-    analyze();
+    ir_instruction* phi = builder.phi(result_type);
 
-    const symbol* symbol = sym_tab.get_symbol(identifier);
+    builder.add_incoming(phi, true_result, true_branch);
+    builder.add_incoming(phi, false_result, false_branch);
 
-    _kind = symbol->kind;
+    result = phi;
+}
 
-    if (symbol->kind == symbol_kind::Parameter)
-    {
-        this->_ptr_reg = ir_builder::format_string("%%%d", -symbol->offset - 1);
-    }
-    else
-    {
-        this->_ptr_reg = static_cast<const variable_symbol*>(symbol)->ptr_reg;
-    }
+identifier_expression::identifier_expression(syntax_token* identifier_token):
+    identifier_expression(identifier_token, symbol_table::instance().get_symbol(identifier_token->id))
+{
 }
 
-type_kind identifier_expression::get_return_type(string identifier)
+identifier_expression::identifier_expression(syntax_token* identifier_token, const symbol* resolved_symbol):
+    expression_syntax(get_return_type(resolved_symbol)), identifier_token(identifier_token), identifier(identifier_token->text), resolved_symbol(resolved_symbol)
 {
-    const symbol* symbol = sym_tab.get_symbol(identifier);
+    analyze();
+}
 
-    if (symbol == nullptr)
+type_kind identifier_expression::get_return_type(const symbol* resolved_symbol)
+{
+    if (resolved_symbol == nullptr)
     {
         return type_kind::Invalid;
     }
 
-    if (symbol->kind != symbol_kind::Variable && symbol->kind != symbol_kind::Parameter)
+    if (resolved_symbol->kind != symbol_kind::Variable && resolved_symbol->kind != symbol_kind::Parameter)
     {
         return type_kind::Invalid;
     }
 
-    return symbol->type;
-}
-
-identifier_expression::~identifier_expression()
-{
-    delete identifier_token;
+    return resolved_symbol->type;
 }
 
 void identifier_expression::analyze() const
 {
-    const symbol* symbol = sym_tab.get_symbol(identifier);
-
-    if (symbol == nullptr)
+    if (resolved_symbol == nullptr)
     {
-        output::error_undef(identifier_token->position, identifier);
+        output::error_undef(identifier_token->position, string(identifier));
     }
 
-    if (symbol->kind != symbol_kind::Variable && symbol->kind != symbol_kind::Parameter)
+    if (resolved_symbol->kind != symbol_kind::Variable && resolved_symbol->kind != symbol_kind::Parameter)
     {
-        output::error_undef(identifier_token->position, identifier);
+        output::error_undef(identifier_token->position, string(identifier));
     }
 }
 
 void identifier_expression::emit()
 {
-    string res_type = ir_builder::get_ir_type(return_type);
-
-    if (_kind == symbol_kind::Parameter)
-    {
-        code_buf.emit("%s = add %s 0, %s", this->reg, res_type, _ptr_reg);
-    }
-    else if (_kind == symbol_kind::Variable)
-    {
-        code_buf.emit("%s = load %s, %s* %s", this->reg, res_type, res_type, _ptr_reg);
-    }
+    result = ir_builder::instance().read_variable(resolved_symbol->slot, ir_builder::get_ir_type(return_type));
 }
 
 invocation_expression::invocation_expression(syntax_token* identifier_token):
-    expression_syntax(get_return_type(identifier_token->text)), identifier_token(identifier_token), identifier(identifier_token->text), arguments(nullptr)
+    invocation_expression(identifier_token, nullptr)
 {
-    analyze();
 }
 
 invocation_expression::invocation_expression(syntax_token* identifier_token, list_syntax<expression_syntax>* arguments):
-    expression_syntax(get_return_type(identifier_token->text)), identifier_token(identifier_token), identifier(identifier_token->text), arguments(arguments)
+    invocation_expression(identifier_token, arguments, static_cast<const function_symbol*>(symbol_table::instance().get_symbol(identifier_token->id, symbol_kind::Function)))
+{
+}
+
+invocation_expression::invocation_expression(syntax_token* identifier_token, list_syntax<expression_syntax>* arguments, const function_symbol* function):
+    expression_syntax(get_return_type(function)), identifier_token(identifier_token), identifier(identifier_token->text), arguments(arguments), function(function)
 {
     analyze();
     add_child(arguments);
 }
 
-type_kind invocation_expression::get_return_type(string identifier)
+type_kind invocation_expression::get_return_type(const function_symbol* function)
 {
-    const symbol* function = sym_tab.get_symbol(identifier, symbol_kind::Function);
-
     if (function == nullptr)
     {
         return type_kind::Invalid;
@@ -386,94 +370,72 @@ type_kind invocation_expression::get_return_type(string identifier)
     return function->type;
 }
 
-invocation_expression::~invocation_expression()
-{
-    delete identifier_token;
-}
-
-string invocation_expression::get_arguments(const list_syntax<expression_syntax>* arguments)
+void invocation_expression::analyze() const
 {
-    if (arguments == nullptr)
+    if (function == nullptr)
     {
-        return "";
+        output::error_undef_func(identifier_token->position, string(identifier));
     }
 
-    stringstream result;
+    const vector<type_kind>& parameter_types = function->parameter_types;
 
-    for (auto iter = arguments->begin(); iter != arguments->end(); iter++)
-    {
-        expression_syntax* arg = *iter;
+    size_t argument_count = arguments == nullptr ? 0 : arguments->size();
 
-        string arg_type = ir_builder::get_ir_type(arg->return_type);
+    if (parameter_types.size() != argument_count)
+    {
+        error_prototype_mismatch();
+    }
 
-        result << arg_type << " " << arg->reg;
+    if (arguments == nullptr)
+    {
+        return;
+    }
 
-        if (std::distance(iter, arguments->end()) > 1)
+    size_t i = 0;
+    for (auto arg : *arguments)
+    {
+        if (types::is_implicitly_convertible(arg->return_type, parameter_types[i++]) == false)
         {
-            result << " , ";
+            error_prototype_mismatch();
         }
     }
-
-    return result.str();
 }
 
-void invocation_expression::analyze() const
+void invocation_expression::error_prototype_mismatch() const
 {
-    const function_symbol* function = static_cast<const function_symbol*>(sym_tab.get_symbol(identifier, symbol_kind::Function));
-
-    if (function == nullptr)
-    {
-        output::error_undef_func(identifier_token->position, identifier);
-    }
-
-    vector<type_kind> parameter_types = function->parameter_types;
-
     vector<string> params_str;
 
-    for (type_kind type : parameter_types)
+    for (type_kind type : function->parameter_types)
     {
         params_str.push_back(types::to_string(type));
     }
 
-    if (arguments == nullptr)
-    {
-        if (parameter_types.size() != 0)
-        {
-            output::error_prototype_mismatch(identifier_token->position, identifier, params_str);
-        }
-    }
-    else
-    {
-        if (parameter_types.size() != arguments->size())
-        {
-            output::error_prototype_mismatch(identifier_token->position, identifier, params_str);
-        }
-
-        size_t i = 0;
-        for (auto arg : *arguments)
-        {
-            if (types::is_implicitly_convertible(arg->return_type, parameter_types[i++]) == false)
-            {
-                output::error_prototype_mismatch(identifier_token->position, identifier, params_str);
-            }
-        }
-    }
+    output::error_prototype_mismatch(identifier_token->position, string(identifier), params_str);
 }
 
 void invocation_expression::emit()
 {
+    ir_builder& builder = ir_builder::instance();
+    vector<ir_value*> values;
+
     if (arguments != nullptr)
     {
         arguments->emit();
+
+        // a byte passed for an int parameter is widened before the call
+        size_t i = 0;
+        for (auto arg : *arguments)
+        {
+            values.push_back(builder.convert(arg->result, ir_builder::get_ir_type(function->parameter_types[i++])));
+        }
     }
 
-    if (return_type == type_kind::Void)
+    ir_instruction* call = builder.call(ir_module::instance().function(identifier), static_cast<uint32_t>(values.size()));
+
+    for (uint32_t i = 0; i < values.size(); i++)
     {
-        code_buf.emit("call void @%s(%s)", identifier, get_arguments(arguments));
-        return;
+        call->set_operand(i, values[i]);
     }
 
-    string ret_str = ir_builder::get_ir_type(return_type);
-
-    code_buf.emit("%s = call %s @%s(%s)", this->reg, ret_str, identifier, get_arguments(arguments));
+    result = call;
 }
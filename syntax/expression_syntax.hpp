@@ -4,12 +4,13 @@
 #include "syntax_token.hpp"
 #include "abstract_syntax.hpp"
 #include "generic_syntax.hpp"
-#include "../emit/code_buffer.hpp"
+#include "../emit/ir_builder.hpp"
 #include "syntax_operators.hpp"
 #include "../errors.hpp"
 #include "../symbol/symbol.hpp"
 #include <vector>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 
 template<typename literal_type> class literal_expression final: public expression_syntax
@@ -34,7 +35,7 @@ template<typename literal_type> class literal_expression final: public expressio
         if (std::is_same<literal_type, unsigned char>::value) return type_kind::Byte;
         if (std::is_same<literal_type, int>::value) return type_kind::Int;
         if (std::is_same<literal_type, bool>::value) return type_kind::Bool;
-        if (std::is_same<literal_type, std::string>::value) return type_kind::String;
+        if (std::is_same<literal_type, std::string_view>::value) return type_kind::String;
         return type_kind::Invalid;
     }
 
@@ -43,11 +44,6 @@ template<typename literal_type> class literal_expression final: public expressio
         throw std::runtime_error("invalid literal_type");
     }
 
-    ~literal_expression()
-    {
-        delete value_token;
-    }
-
     void analyze() const override
     {
         if (types::is_special(return_type) && return_type != type_kind::String)
@@ -58,34 +54,30 @@ template<typename literal_type> class literal_expression final: public expressio
 
     void emit() override
     {
-        code_buffer& code_buf = code_buffer::instance();
-
-        std::string ret_type = ir_builder::get_ir_type(return_type);
-
-        code_buf.emit("%s = add %s 0, %d", this->reg, ret_type, value);
+        result = ir_builder::instance().constant(ir_builder::get_ir_type(return_type), value);
     }
 };
 
 template<> inline int literal_expression<int>::get_literal_value(syntax_token* value_token) const
 {
-    return std::stoi(value_token->text);
+    return std::stoi(std::string(value_token->text));
 }
 
 template<> inline unsigned char literal_expression<unsigned char>::get_literal_value(syntax_token* value_token) const
 {
-    int value = std::stoi(value_token->text);
+    int value = std::stoi(std::string(value_token->text));
 
     if (value < 0 || value > 255)
     {
-        output::error_byte_too_large(value_token->position, value_token->text);
+        output::error_byte_too_large(value_token->position, std::string(value_token->text));
     }
 
     return static_cast<unsigned char>(value);
 }
 
-template<> inline std::string literal_expression<std::string>::get_literal_value(syntax_token* value_token) const
+template<> inline std::string_view literal_expression<std::string_view>::get_literal_value(syntax_token* value_token) const
 {
-    return std::string(value_token->text);
+    return value_token->text;
 }
 
 template<> inline bool literal_expression<bool>::get_literal_value(syntax_token* value_token) const
@@ -96,17 +88,9 @@ template<> inline bool literal_expression<bool>::get_literal_value(syntax_token*
     throw std::runtime_error("invalid value_token text");
 }
 
-template<> inline void literal_expression<std::string>::emit()
+template<> inline void literal_expression<std::string_view>::emit()
 {
-    code_buffer& code_buf = code_buffer::instance();
-
-    std::string arr_name = ir_builder::fresh_global();
-    std::string arr_content = value.substr(1, value.length() - 2);
-    std::string arr_type = ir_builder::format_string("[%d x i8]", arr_content.length() + 1);
-
-    code_buf.emit_global(ir_builder::format_string("%s = constant %s c\"%s\\00\"", arr_name, arr_type, arr_content));
-
-    code_buf.emit("%s = getelementptr %s, %s* %s, i32 0, i32 0", reg, arr_type, arr_type, arr_name);
+    result = ir_builder::instance().string_constant(value.substr(1, value.length() - 2));
 }
 
 class cast_expression final: public expression_syntax
@@ -134,13 +118,14 @@ class not_expression final: public expression_syntax
     expression_syntax* const expression;
 
     not_expression(syntax_token* not_token, expression_syntax* expression);
-    ~not_expression();
+    ~not_expression() = default;
 
     not_expression(const not_expression& other) = delete;
     not_expression& operator=(const not_expression& other) = delete;
 
     void analyze() const override;
     void emit() override;
+    void emit_condition() override;
 };
 
 class logical_expression final: public expression_syntax
@@ -155,17 +140,18 @@ class logical_expression final: public expression_syntax
     const operator_kind oper;
 
     logical_expression(expression_syntax* left, syntax_token* oper_token, expression_syntax* right);
-    ~logical_expression();
+    ~logical_expression() = default;
 
     logical_expression(const logical_expression& other) = delete;
     logical_expression& operator=(const logical_expression& other) = delete;
 
     void analyze() const override;
     void emit() override;
+    void emit_condition() override;
 
     private:
 
-    static operator_kind parse_operator(std::string str);
+    static operator_kind parse_operator(std::string_view str);
 };
 
 class arithmetic_expression final: public expression_syntax
@@ -178,7 +164,7 @@ class arithmetic_expression final: public expression_syntax
     const arithmetic_operator oper;
 
     arithmetic_expression(expression_syntax* left, syntax_token* oper_token, expression_syntax* right);
-    ~arithmetic_expression();
+    ~arithmetic_expression() = default;
 
     arithmetic_expression(const arithmetic_expression& other) = delete;
     arithmetic_expression& operator=(const arithmetic_expression& other) = delete;
@@ -188,7 +174,7 @@ class arithmetic_expression final: public expression_syntax
 
     private:
 
-    static arithmetic_operator parse_operator(std::string str);
+    static arithmetic_operator parse_operator(std::string_view str);
 };
 
 class relational_expression final: public expression_syntax
@@ -201,7 +187,7 @@ class relational_expression final: public expression_syntax
     const relational_operator oper;
 
     relational_expression(expression_syntax* left, syntax_token* oper_token, expression_syntax* right);
-    ~relational_expression();
+    ~relational_expression() = default;
 
     relational_expression(const relational_expression& other) = delete;
     relational_expression& operator=(const relational_expression& other) = delete;
@@ -211,7 +197,7 @@ class relational_expression final: public expression_syntax
 
     private:
 
-    static relational_operator parse_operator(std::string str);
+    static relational_operator parse_operator(std::string_view str);
 };
 
 class conditional_expression final: public expression_syntax
@@ -225,7 +211,7 @@ class conditional_expression final: public expression_syntax
     expression_syntax* const false_value;
 
     conditional_expression(expression_syntax* true_value, syntax_token* if_token, expression_syntax* condition, syntax_token* else_token, expression_syntax* false_value);
-    ~conditional_expression();
+    ~conditional_expression() = default;
 
     conditional_expression(const conditional_expression& other) = delete;
     conditional_expression& operator=(const conditional_expression& other) = delete;
@@ -243,17 +229,11 @@ class identifier_expression final: public expression_syntax
     public:
 
     const syntax_token* const identifier_token;
-    const std::string identifier;
-
-    private:
-
-    symbol_kind _kind;
-    std::string _ptr_reg;
-
-    public:
+    const std::string_view identifier;
+    const symbol* const resolved_symbol;
 
     identifier_expression(syntax_token* identifier_token);
-    ~identifier_expression();
+    ~identifier_expression() = default;
 
     identifier_expression(const identifier_expression& other) = delete;
     identifier_expression& operator=(const identifier_expression& other) = delete;
@@ -263,7 +243,9 @@ class identifier_expression final: public expression_syntax
 
     private:
 
-    static type_kind get_return_type(std::string identifier);
+    identifier_expression(syntax_token* identifier_token, const symbol* resolved_symbol);
+
+    static type_kind get_return_type(const symbol* resolved_symbol);
 };
 
 class invocation_expression final: public expression_syntax
@@ -271,12 +253,13 @@ class invocation_expression final: public expression_syntax
     public:
 
     const syntax_token* const identifier_token;
-    const std::string identifier;
+    const std::string_view identifier;
     list_syntax<expression_syntax>* const arguments;
+    const function_symbol* const function;
 
     invocation_expression(syntax_token* identifier_token);
     invocation_expression(syntax_token* identifier_token, list_syntax<expression_syntax>* arguments);
-    ~invocation_expression();
+    ~invocation_expression() = default;
 
     invocation_expression(const invocation_expression& other) = delete;
     invocation_expression& operator=(const invocation_expression& other) = delete;
@@ -286,8 +269,11 @@ class invocation_expression final: public expression_syntax
 
     private:
 
-    static type_kind get_return_type(std::string identifier);
-    static std::string get_arguments(const list_syntax<expression_syntax>* arguments);
+    invocation_expression(syntax_token* identifier_token, list_syntax<expression_syntax>* arguments, const function_symbol* function);
+
+    [[noreturn]] void error_prototype_mismatch() const;
+
+    static type_kind get_return_type(const function_symbol* function);
 };
 
 #endif
\ No newline at end of file
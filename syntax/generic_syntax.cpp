@@ -2,16 +2,13 @@
 #include "../errors.hpp"
 #include "../symbol/symbol.hpp"
 #include "../symbol/symbol_table.hpp"
-#include <sstream>
+#include "../compilation_context.hpp"
 #include <vector>
 
 using std::string;
-using std::stringstream;
+using std::string_view;
 using std::vector;
 
-static symbol_table& sym_tab = symbol_table::instance();
-static code_buffer& code_buf = code_buffer::instance();
-
 type_syntax::type_syntax(syntax_token* type_token): type_token(type_token), kind(types::parse(type_token->text))
 {
 }
@@ -34,11 +31,6 @@ void type_syntax::emit()
 {
 }
 
-type_syntax::~type_syntax()
-{
-    delete type_token;
-}
-
 parameter_syntax::parameter_syntax(type_syntax* type, syntax_token* identifier_token):
     type(type), identifier_token(identifier_token), identifier(identifier_token->text)
 {
@@ -46,11 +38,6 @@ parameter_syntax::parameter_syntax(type_syntax* type, syntax_token* identifier_t
     add_child(type);
 }
 
-parameter_syntax::~parameter_syntax()
-{
-    delete identifier_token;
-}
-
 void parameter_syntax::analyze() const
 {
     if (type->kind == type_kind::Void)
@@ -58,9 +45,9 @@ void parameter_syntax::analyze() const
         output::error_mismatch(identifier_token->position);
     }
 
-    if (sym_tab.contains_symbol(identifier))
+    if (symbol_table::instance().contains_symbol(identifier_token->id))
     {
-        output::error_def(identifier_token->position, identifier);
+        output::error_def(identifier_token->position, string(identifier));
     }
 }
 
@@ -71,6 +58,8 @@ void parameter_syntax::emit()
 function_header_syntax::function_header_syntax(type_syntax* return_type, syntax_token* identifier_token, list_syntax<parameter_syntax>* parameters):
     return_type(return_type), identifier_token(identifier_token), identifier(identifier_token->text), parameters(parameters)
 {
+    symbol_table& sym_tab = symbol_table::instance();
+
     analyze();
 
     vector<type_kind> param_types;
@@ -80,56 +69,46 @@ function_header_syntax::function_header_syntax(type_syntax* return_type, syntax_
         param_types.push_back(param->type->kind);
     }
 
-    sym_tab.add_function(identifier_token->text, return_type->kind, param_types);
+    sym_tab.add_function(identifier_token->id, return_type->kind, param_types);
 
     sym_tab.open_scope();
 
     for (auto param : *parameters)
     {
-        sym_tab.add_parameter(param->identifier, param->type->kind);
+        sym_tab.add_parameter(param->identifier_token->id, param->type->kind);
     }
 
     add_children({ return_type, parameters });
 }
 
-function_header_syntax::~function_header_syntax()
-{
-    delete identifier_token;
-}
-
 void function_header_syntax::analyze() const
 {
-    string func_name = identifier_token->text;
-
-    if (sym_tab.contains_symbol(func_name))
+    if (symbol_table::instance().contains_symbol(identifier_token->id))
     {
-        output::error_def(identifier_token->position, func_name);
+        output::error_def(identifier_token->position, string(identifier));
     }
 }
 
 void function_header_syntax::emit()
 {
-    parameters->emit();
-
-    stringstream header_text;
+    ir_builder& builder = ir_builder::instance();
 
-    string ret_type = ir_builder::get_ir_type(this->return_type->kind);
+    parameters->emit();
 
-    header_text << ir_builder::format_string("define %s @%s (", ret_type, this->identifier);
+    vector<type_kind> param_types;
 
-    for (auto param = parameters->begin(); param != parameters->end(); param++)
+    for (auto param : *parameters)
     {
-        header_text << ir_builder::get_ir_type((*param)->type->kind);
-
-        if (std::distance(param, parameters->end()) > 1)
-        {
-            header_text << " , ";
-        }
+        param_types.push_back(param->type->kind);
     }
 
-    header_text << ")";
+    builder.begin_function(builder.declare_function(identifier_table::instance().text(identifier_token->id), return_type->kind, param_types));
 
-    code_buf.emit(header_text.str());
+    // parameters take the first slots and are assigned like locals
+    for (uint32_t i = 0; i < param_types.size(); i++)
+    {
+        builder.define_variable(i, builder.argument(i));
+    }
 }
 
 function_declaration_syntax::function_declaration_syntax(function_header_syntax* header, list_syntax<statement_syntax>* body):
@@ -145,31 +124,39 @@ void function_declaration_syntax::analyze() const
 
 void function_declaration_syntax::emit()
 {
-    header->emit();
-
-    code_buf.emit("{");
-
-    code_buf.increase_indent();
+    ir_builder& builder = ir_builder::instance();
 
-    body->emit();
+    header->emit();
 
-    if (header->identifier == "main")
+    for (statement_syntax* statement : *body)
     {
-        code_buf.emit("call void @exit(i32 0)");
-    }
+        if (builder.terminated())
+        {
+            break;
+        }
 
-    if (header->return_type->kind == type_kind::Void)
-    {
-        code_buf.emit("ret void");
+        statement->emit();
     }
-    else
+
+    // the fallback return is only needed when the body can fall off its end
+    if (builder.terminated() == false)
     {
-        code_buf.emit("ret %s 0", ir_builder::get_ir_type(header->return_type->kind));
-    }
+        if (header->identifier == "main")
+        {
+            builder.call(ir_module::instance().function("exit"), 1)->set_operand(0, builder.constant(ir_type::I32, 0));
+        }
 
-    code_buf.decrease_indent();
+        if (header->return_type->kind == type_kind::Void)
+        {
+            builder.ret();
+        }
+        else
+        {
+            builder.ret(builder.constant(ir_builder::get_ir_type(header->return_type->kind), 0));
+        }
+    }
 
-    code_buf.emit("}\n");
+    builder.end_function();
 }
 
 root_syntax::root_syntax(list_syntax<function_declaration_syntax>* functions): functions(functions)
@@ -180,7 +167,7 @@ root_syntax::root_syntax(list_syntax<function_declaration_syntax>* functions): f
 
 void root_syntax::analyze() const
 {
-    const function_symbol* main = static_cast<const function_symbol*>(sym_tab.get_symbol("main", symbol_kind::Function));
+    const function_symbol* main = static_cast<const function_symbol*>(symbol_table::instance().get_symbol(identifier_table::instance().intern("main"), symbol_kind::Function));
 
     if (main == nullptr)
     {
@@ -196,4 +183,6 @@ void root_syntax::analyze() const
 void root_syntax::emit()
 {
     functions->emit();
+
+    compilation_context::current().write_module();
 }
@@ -3,15 +3,16 @@
 
 #include "syntax_token.hpp"
 #include "abstract_syntax.hpp"
-#include <list>
+#include "../memory/arena.hpp"
 #include <vector>
 #include <string>
+#include <string_view>
 
 template<typename element_type> class list_syntax final: public syntax_base
 {
     private:
 
-    std::list<element_type*> _elements;
+    arena_list<element_type*> _elements;
 
     public:
 
@@ -54,7 +55,7 @@ template<typename element_type> class list_syntax final: public syntax_base
     {
         _elements.push_front(element);
 
-        add_child_front(element);
+        add_child(element);
 
         return this;
     }
@@ -64,12 +65,12 @@ template<typename element_type> class list_syntax final: public syntax_base
         return _elements.size();
     }
 
-    typename std::list<element_type*>::const_iterator begin() const
+    typename arena_list<element_type*>::const_iterator begin() const
     {
         return _elements.begin();
     }
 
-    typename std::list<element_type*>::const_iterator end() const
+    typename arena_list<element_type*>::const_iterator end() const
     {
         return _elements.end();
     }
@@ -96,7 +97,7 @@ class type_syntax final: public syntax_base
     const type_kind kind;
 
     type_syntax(syntax_token* type_token);
-    ~type_syntax();
+    ~type_syntax() = default;
 
     type_syntax(const type_syntax& other) = delete;
     type_syntax& operator=(const type_syntax& other) = delete;
@@ -114,10 +115,10 @@ class parameter_syntax final: public syntax_base
 
     type_syntax* const type;
     const syntax_token* const identifier_token;
-    const std::string identifier;
+    const std::string_view identifier;
 
     parameter_syntax(type_syntax* type, syntax_token* identifier_token);
-    ~parameter_syntax();
+    ~parameter_syntax() = default;
 
     parameter_syntax(const parameter_syntax& other) = delete;
     parameter_syntax& operator=(const parameter_syntax& other) = delete;
@@ -132,11 +133,11 @@ class function_header_syntax final: public syntax_base
 
     type_syntax* const return_type;
     const syntax_token* const identifier_token;
-    const std::string identifier;
+    const std::string_view identifier;
     list_syntax<parameter_syntax>* const parameters;
 
     function_header_syntax(type_syntax* return_type, syntax_token* identifier_token, list_syntax<parameter_syntax>* parameters);
-    ~function_header_syntax();
+    ~function_header_syntax() = default;
 
     function_header_syntax(const function_header_syntax& other) = delete;
     function_header_syntax& operator=(const function_header_syntax& other) = delete;
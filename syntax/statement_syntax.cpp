@@ -2,15 +2,10 @@
 #include "../errors.hpp"
 #include "../symbol/symbol_table.hpp"
 #include "abstract_syntax.hpp"
-#include <list>
-#include <algorithm>
 #include <stdexcept>
 
 using std::string;
-using std::list;
-
-static symbol_table& sym_tab = symbol_table::instance();
-static code_buffer& code_buf = code_buffer::instance();
+using std::string_view;
 
 if_statement::if_statement(syntax_token* if_token, expression_syntax* condition, statement_syntax* body):
     if_token(if_token), condition(condition), body(body), else_token(nullptr), else_clause(nullptr)
@@ -26,12 +21,6 @@ if_statement::if_statement(syntax_token* if_token, expression_syntax* condition,
     add_children({ condition , body, else_clause });
 }
 
-if_statement::~if_statement()
-{
-    delete if_token;
-    delete else_token;
-}
-
 void if_statement::analyze() const
 {
     if (condition->return_type != type_kind::Bool)
@@ -42,49 +31,36 @@ void if_statement::analyze() const
 
 void if_statement::emit()
 {
-    string true_label = ir_builder::fresh_label();
-    string false_label = ir_builder::fresh_label();
-    string end_label = ir_builder::fresh_label();
+    ir_builder& builder = ir_builder::instance();
 
-    condition->emit();
+    ir_basic_block* end_block = builder.create_block();
 
-    if (else_clause == nullptr)
-    {
-        code_buf.emit("br i1 %s, label %%%s, label %%%s", condition->reg, true_label, end_label);
+    condition->emit_condition();
 
-        code_buf.increase_indent();
-        code_buf.emit("%s:", true_label);
-        body->emit();
-        code_buf.emit("br label %%%s", end_label);
-        code_buf.decrease_indent();
+    builder.land(condition->true_list);
+    body->emit();
+    builder.branch(end_block);
 
-        code_buf.emit("%s:", end_label);
+    if (else_clause == nullptr)
+    {
+        builder.backpatch(condition->false_list, end_block);
+        builder.place(end_block);
 
-        break_list = body->break_list;
-        continue_list = body->continue_list;
+        builder.merge(break_list, body->break_list);
+        builder.merge(continue_list, body->continue_list);
     }
     else
     {
-        code_buf.emit("br i1 %s, label %%%s, label %%%s", condition->reg, true_label, false_label);
-
-        code_buf.increase_indent();
-        code_buf.emit("%s:", true_label);
-        body->emit();
-        code_buf.emit("br label %%%s", end_label);
-        code_buf.decrease_indent();
-
-        code_buf.increase_indent();
-        code_buf.emit("%s:", false_label);
+        builder.land(condition->false_list);
         else_clause->emit();
-        code_buf.emit("br label %%%s", end_label);
-        code_buf.decrease_indent();
+        builder.branch(end_block);
 
-        code_buf.emit("%s:", end_label);
+        builder.place(end_block);
 
-        break_list.merge(body->break_list);
-        break_list.merge(else_clause->break_list);
-        continue_list.merge(body->continue_list);
-        continue_list.merge(else_clause->continue_list);
+        builder.merge(break_list, body->break_list);
+        builder.merge(break_list, else_clause->break_list);
+        builder.merge(continue_list, body->continue_list);
+        builder.merge(continue_list, else_clause->continue_list);
     }
 }
 
@@ -95,11 +71,6 @@ while_statement::while_statement(syntax_token* while_token, expression_syntax* c
     add_children({ condition, body });
 }
 
-while_statement::~while_statement()
-{
-    delete while_token;
-}
-
 void while_statement::analyze() const
 {
     if (condition->return_type != type_kind::Bool)
@@ -110,28 +81,25 @@ void while_statement::analyze() const
 
 void while_statement::emit()
 {
-    string cond_label = ir_builder::fresh_label();
-    string body_label = ir_builder::fresh_label();
-    string end_label = ir_builder::fresh_label();
+    ir_builder& builder = ir_builder::instance();
 
-    code_buf.emit("br label %%%s", cond_label);
-    code_buf.emit("%s:", cond_label);
-    condition->emit();
-    code_buf.emit("br i1 %s, label %%%s, label %%%s", condition->reg, body_label, end_label);
+    ir_basic_block* cond_block = builder.create_block();
+    ir_basic_block* end_block = builder.create_block();
 
-    code_buf.increase_indent();
-    code_buf.emit("%s:", body_label);
-    body->emit();
-    code_buf.emit("br label %%%s", cond_label);
-    code_buf.decrease_indent();
+    builder.branch(cond_block);
+    builder.place_unsealed(cond_block);
+    condition->emit_condition();
 
-    code_buf.emit("%s:", end_label);
+    builder.land(condition->true_list);
+    body->emit();
+    builder.branch(cond_block);
 
-    code_buf.backpatch(body->break_list, end_label);
-    code_buf.backpatch(body->continue_list, cond_label);
+    builder.backpatch(condition->false_list, end_block);
+    builder.backpatch(body->break_list, end_block);
+    builder.backpatch(body->continue_list, cond_block);
+    builder.seal(cond_block);
 
-    body->break_list.clear();
-    body->continue_list.clear();
+    builder.place(end_block);
 }
 
 branch_statement::branch_statement(syntax_token* branch_token): branch_token(branch_token), kind(parse_kind(branch_token->text))
@@ -139,12 +107,7 @@ branch_statement::branch_statement(syntax_token* branch_token): branch_token(bra
     analyze();
 }
 
-branch_statement::~branch_statement()
-{
-    delete branch_token;
-}
-
-branch_statement::branch_kind branch_statement::parse_kind(string str)
+branch_statement::branch_kind branch_statement::parse_kind(string_view str)
 {
     if (str == "break") return branch_kind::Break;
     if (str == "continue") return branch_kind::Continue;
@@ -154,9 +117,7 @@ branch_statement::branch_kind branch_statement::parse_kind(string str)
 
 void branch_statement::analyze() const
 {
-    const list<scope>& scopes = sym_tab.scopes();
-
-    if (std::all_of(scopes.rbegin(), scopes.rend(), [](const scope& sc) { return sc.loop_scope == false; }))
+    if (symbol_table::instance().in_loop() == false)
     {
         if (kind == branch_kind::Break)
         {
@@ -174,50 +135,34 @@ void branch_statement::analyze() const
 
 void branch_statement::emit()
 {
-    size_t line = code_buf.emit("br label @");
-
-    if (kind == branch_kind::Continue)
-    {
-        continue_list.push_back(line);
-    }
-    else
-    {
-        break_list.push_back(line);
-    }
+    ir_builder::instance().branch(kind == branch_kind::Continue ? continue_list : break_list);
 }
 
-return_statement::return_statement(syntax_token* return_token): return_token(return_token), value(nullptr)
+return_statement::return_statement(syntax_token* return_token):
+    return_token(return_token), value(nullptr), function_type(symbol_table::instance().current_function()->type)
 {
     analyze();
 }
 
-return_statement::return_statement(syntax_token* return_token, expression_syntax* value): return_token(return_token), value(value)
+return_statement::return_statement(syntax_token* return_token, expression_syntax* value):
+    return_token(return_token), value(value), function_type(symbol_table::instance().current_function()->type)
 {
     analyze();
     add_child(value);
 }
 
-return_statement::~return_statement()
-{
-    delete return_token;
-}
-
 void return_statement::analyze() const
 {
-    auto& global_symbols = sym_tab.scopes().front().symbols();
-
-    const symbol* func_sym = global_symbols.back();
-
     if (value == nullptr)
     {
-        if (func_sym->type != type_kind::Void)
+        if (function_type != type_kind::Void)
         {
             output::error_mismatch(return_token->position);
         }
     }
     else
     {
-        if (types::is_implicitly_convertible(value->return_type, func_sym->type) == false)
+        if (types::is_implicitly_convertible(value->return_type, function_type) == false)
         {
             output::error_mismatch(return_token->position);
         }
@@ -226,15 +171,17 @@ void return_statement::analyze() const
 
 void return_statement::emit()
 {
+    ir_builder& builder = ir_builder::instance();
+
     if (value == nullptr)
     {
-        code_buf.emit("ret void");
+        builder.ret();
     }
     else
     {
         value->emit();
 
-        code_buf.emit("ret %s %s", ir_builder::get_ir_type(value->return_type), value->reg);
+        builder.ret(builder.convert(value->result, ir_builder::get_ir_type(function_type)));
     }
 }
 
@@ -253,38 +200,26 @@ void expression_statement::emit()
 }
 
 assignment_statement::assignment_statement(syntax_token* identifier_token, syntax_token* assign_token, expression_syntax* value):
-    identifier_token(identifier_token), identifier(identifier_token->text), assign_token(assign_token), value(value), _ptr_reg()
+    identifier_token(identifier_token), identifier(identifier_token->text), assign_token(assign_token), value(value),
+    resolved_symbol(symbol_table::instance().get_symbol(identifier_token->id))
 {
     analyze();
-
-    const symbol* symbol = sym_tab.get_symbol(identifier);
-
-    this->_ptr_reg = static_cast<const variable_symbol*>(symbol)->ptr_reg;
-
     add_child(value);
 }
 
-assignment_statement::~assignment_statement()
-{
-    delete identifier_token;
-    delete assign_token;
-}
-
 void assignment_statement::analyze() const
 {
-    const symbol* symbol = sym_tab.get_symbol(identifier);
-
-    if (symbol == nullptr)
+    if (resolved_symbol == nullptr)
     {
-        output::error_undef(identifier_token->position, identifier);
+        output::error_undef(identifier_token->position, string(identifier));
     }
 
-    if (symbol->kind != symbol_kind::Variable && symbol->kind != symbol_kind::Parameter)
+    if (resolved_symbol->kind != symbol_kind::Variable && resolved_symbol->kind != symbol_kind::Parameter)
     {
-        output::error_undef(identifier_token->position, identifier);
+        output::error_undef(identifier_token->position, string(identifier));
     }
 
-    if (types::is_implicitly_convertible(value->return_type, symbol->type) == false)
+    if (types::is_implicitly_convertible(value->return_type, resolved_symbol->type) == false)
     {
         output::error_mismatch(assign_token->position);
     }
@@ -292,47 +227,33 @@ void assignment_statement::analyze() const
 
 void assignment_statement::emit()
 {
-    string res_type = ir_builder::get_ir_type(value->return_type);
+    ir_builder& builder = ir_builder::instance();
 
     value->emit();
 
-    code_buf.emit("store %s %s, %s* %s", res_type, value->reg, res_type, _ptr_reg);
+    builder.write_variable(resolved_symbol->slot, builder.convert(value->result, ir_builder::get_ir_type(resolved_symbol->type)));
 }
 
 declaration_statement::declaration_statement(type_syntax* type, syntax_token* identifier_token):
-    type(type), identifier_token(identifier_token), identifier(identifier_token->text), assign_token(nullptr), value(nullptr), _ptr_reg()
+    type(type), identifier_token(identifier_token), identifier(identifier_token->text), assign_token(nullptr), value(nullptr), _symbol(nullptr)
 {
     analyze();
 
-    sym_tab.add_variable(identifier, type->kind);
-
-    const symbol* sym = sym_tab.get_symbol(identifier, symbol_kind::Variable);
-
-    this->_ptr_reg = static_cast<const variable_symbol*>(sym)->ptr_reg;
+    _symbol = symbol_table::instance().add_variable(identifier_token->id, type->kind);
 
     add_child(type);
 }
 
 declaration_statement::declaration_statement(type_syntax* type, syntax_token* identifier_token, syntax_token* assign_token, expression_syntax* value):
-    type(type), identifier_token(identifier_token), identifier(identifier_token->text), assign_token(assign_token), value(value), _ptr_reg()
+    type(type), identifier_token(identifier_token), identifier(identifier_token->text), assign_token(assign_token), value(value), _symbol(nullptr)
 {
     analyze();
 
-    sym_tab.add_variable(identifier, type->kind);
-
-    const symbol* sym = sym_tab.get_symbol(identifier, symbol_kind::Variable);
-
-    this->_ptr_reg = static_cast<const variable_symbol*>(sym)->ptr_reg;
+    _symbol = symbol_table::instance().add_variable(identifier_token->id, type->kind);
 
     add_children({ type ,value });
 }
 
-declaration_statement::~declaration_statement()
-{
-    delete identifier_token;
-    delete assign_token;
-}
-
 void declaration_statement::analyze() const
 {
     if (type->is_special())
@@ -348,31 +269,24 @@ void declaration_statement::analyze() const
         }
     }
 
-    if (sym_tab.contains_symbol(identifier))
+    if (symbol_table::instance().contains_symbol(identifier_token->id))
     {
-        output::error_def(identifier_token->position, identifier);
+        output::error_def(identifier_token->position, string(identifier));
     }
 }
 
 void declaration_statement::emit()
 {
-    string res_type = ir_builder::get_ir_type(this->type->kind);
+    ir_builder& builder = ir_builder::instance();
+
+    ir_type res_type = ir_builder::get_ir_type(this->type->kind);
 
     if (value != nullptr)
     {
         value->emit();
     }
 
-    code_buf.emit("%s = alloca %s", _ptr_reg, res_type);
-
-    if (value != nullptr)
-    {
-        code_buf.emit("store %s %s, %s* %s", res_type, value->reg, res_type, _ptr_reg);
-    }
-    else
-    {
-        code_buf.emit("store %s 0, %s* %s", res_type, res_type, _ptr_reg);
-    }
+    builder.define_variable(_symbol->slot, value != nullptr ? builder.convert(value->result, res_type) : builder.constant(res_type, 0));
 }
 
 block_statement::block_statement(list_syntax<statement_syntax>* statements): statements(statements)
@@ -386,11 +300,19 @@ void block_statement::analyze() const
 
 void block_statement::emit()
 {
-    statements->emit();
+    ir_builder& builder = ir_builder::instance();
 
     for (auto statement : *statements)
     {
-        break_list.merge(statement->break_list);
-        continue_list.merge(statement->continue_list);
+        // nothing after a return, break or continue can run
+        if (builder.terminated())
+        {
+            break;
+        }
+
+        statement->emit();
+
+        builder.merge(break_list, statement->break_list);
+        builder.merge(continue_list, statement->continue_list);
     }
 }
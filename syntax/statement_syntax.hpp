@@ -7,6 +7,7 @@
 #include "generic_syntax.hpp"
 #include <vector>
 #include <string>
+#include <string_view>
 
 class if_statement final: public statement_syntax
 {
@@ -20,7 +21,7 @@ class if_statement final: public statement_syntax
 
     if_statement(syntax_token* if_token, expression_syntax* condition, statement_syntax* body);
     if_statement(syntax_token* if_token, expression_syntax* condition, statement_syntax* body, syntax_token* else_token, statement_syntax* else_clause);
-    ~if_statement();
+    ~if_statement() = default;
 
     if_statement(const if_statement& other) = delete;
     if_statement& operator=(const if_statement& other) = delete;
@@ -38,7 +39,7 @@ class while_statement final: public statement_syntax
     statement_syntax* const body;
 
     while_statement(syntax_token* while_token, expression_syntax* condition, statement_syntax* body);
-    ~while_statement();
+    ~while_statement() = default;
 
     while_statement(const while_statement& other) = delete;
     while_statement& operator=(const while_statement& other) = delete;
@@ -57,7 +58,7 @@ class branch_statement final: public statement_syntax
     const branch_kind kind;
 
     branch_statement(syntax_token* branch_token);
-    ~branch_statement();
+    ~branch_statement() = default;
 
     branch_statement(const branch_statement& other) = delete;
     branch_statement& operator=(const branch_statement& other) = delete;
@@ -67,7 +68,7 @@ class branch_statement final: public statement_syntax
 
     private:
 
-    static branch_kind parse_kind(std::string str);
+    static branch_kind parse_kind(std::string_view str);
 };
 
 class return_statement final: public statement_syntax
@@ -76,10 +77,11 @@ class return_statement final: public statement_syntax
 
     const syntax_token* const return_token;
     expression_syntax* const value;
+    const type_kind function_type;
 
     return_statement(syntax_token* return_token);
     return_statement(syntax_token* return_token, expression_syntax* value);
-    ~return_statement();
+    ~return_statement() = default;
 
     return_statement(const return_statement& other) = delete;
     return_statement& operator=(const return_statement& other) = delete;
@@ -109,18 +111,13 @@ class assignment_statement final: public statement_syntax
     public:
 
     const syntax_token* const identifier_token;
-    const std::string identifier;
+    const std::string_view identifier;
     const syntax_token* const assign_token;
     expression_syntax* const value;
-
-    private:
-
-    std::string _ptr_reg;
-
-    public:
+    const symbol* const resolved_symbol;
 
     assignment_statement(syntax_token* identifier_token, syntax_token* assign_token, expression_syntax* value);
-    ~assignment_statement();
+    ~assignment_statement() = default;
 
     assignment_statement(const assignment_statement& other) = delete;
     assignment_statement& operator=(const assignment_statement& other) = delete;
@@ -135,19 +132,19 @@ class declaration_statement final: public statement_syntax
 
     type_syntax* const type;
     const syntax_token* const identifier_token;
-    const std::string identifier;
+    const std::string_view identifier;
     const syntax_token* const assign_token;
     expression_syntax* const value;
 
     private:
 
-    std::string _ptr_reg;
+    const variable_symbol* _symbol;
 
     public:
 
     declaration_statement(type_syntax* type, syntax_token* identifier_token);
     declaration_statement(type_syntax* type, syntax_token* identifier_token, syntax_token* assign_token, expression_syntax* value);
-    ~declaration_statement();
+    ~declaration_statement() = default;
 
     declaration_statement(const declaration_statement& other) = delete;
     declaration_statement& operator=(const declaration_statement& other) = delete;
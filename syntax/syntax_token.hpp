@@ -1,7 +1,9 @@
 #ifndef _SYNTAX_TOKEN_HPP_
 #define _SYNTAX_TOKEN_HPP_
 
-#include <string>
+#include "../memory/arena.hpp"
+#include "../symbol/identifier_table.hpp"
+#include <string_view>
 
 class syntax_token
 {
@@ -9,12 +11,29 @@ class syntax_token
 
     const int type;
     const int position;
-    const std::string text;
+    const identifier_id id;
+    const std::string_view text;
 
-    syntax_token(int type, int position, const std::string& text): type(type), position(position), text(text)
+    syntax_token(int type, int position, std::string_view text):
+        type(type), position(position), id(identifier_table::invalid_id), text(text)
     {
 
     }
+
+    syntax_token(int type, int position, identifier_id id):
+        type(type), position(position), id(id), text(identifier_table::instance().text(id))
+    {
+
+    }
+
+    static void* operator new(std::size_t size)
+    {
+        return arena::instance().allocate(size, alignof(syntax_token));
+    }
+
+    static void operator delete(void*)
+    {
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
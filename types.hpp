@@ -2,13 +2,14 @@
 #define _TYPES_H_
 
 #include <string>
+#include <string_view>
 
 enum class type_kind { Invalid, Void, Int, Bool, Byte, String };
 
 namespace types
 {
     std::string to_string(type_kind type);
-    type_kind parse(const std::string& str);
+    type_kind parse(std::string_view str);
 
     bool is_numeric(type_kind type);
     bool is_special(type_kind type);